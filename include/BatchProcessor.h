@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BoardState.h"
+#include "CameraCalibration.h"
+#include "ColorDetector.h"
+
+class MosaicEngine;
+
+struct BatchConfig {
+    int workers = 0;                // 0: donanım çekirdek sayısı
+    int warmup_frames = 30;         // Segment başından önce işlenen frame (oylamalar + renk geçmişi)
+    SamplingConfig sampling;
+    std::vector<int> template_marker_ids;   // MosaicEngine::setTemplateMarkerIds
+    CameraCalibration calibration;          // Geçersizse lens bozulması düzeltilmez
+    int mjpeg_detection_scale = 2;          // MosaicEngine::setMjpegDetectionScale
+    // Boşta modu ve tahta ortalaması kullanılmaz: durumları segmentler arasında birebir
+    // yakınsamaz (bkz. main.cpp, --batch ile --idle / --accumulate reddedilir)
+};
+
+struct BatchResult {
+    std::vector<BoardState> states;     // Frame sırasıyla, frame_index = kayıttaki sıra
+    double seconds = 0.0;
+    size_t segments = 0;
+    size_t fixed_up_frames = 0;         // Durum uyuşmadığı için sıralı olarak yeniden işlenen
+    size_t unseekable_segments = 0;     // Konumlama frame-doğru olmadığı için baştan decode edilen
+};
+
+// Uzun kayıtları (.mrec veya video) zaman segmentlerine bölüp tüm çekirdeklerde işler.
+// Her segment, ısınma frame'lerinden sonra bir önceki segmentin bitiş durumuyla
+// karşılaştırılır; farklıysa segment, durumlar yakınsayana kadar sıralı olarak yeniden
+// işlenir. Böylece çıktı sıralı çalışmayla birebir aynıdır. Segment sınırları frame
+// içeriğiyle doğrulanır; video konumlaması kayarsa segmentler baştan decode edilir.
+class BatchProcessor {
+private:
+    std::vector<std::string> template_paths_;
+    std::vector<std::string> template_names_;
+    int target_marker_id_;
+    BatchConfig config_;
+
+    // Segment, düzeltme ve sıralı çalışma motorları aynı ayarlarla buradan kurulur
+    std::unique_ptr<MosaicEngine> makeEngine() const;
+
+public:
+    BatchProcessor(const std::vector<std::string>& template_paths,
+        const std::vector<std::string>& template_names,
+        int target_marker_id,
+        const BatchConfig& config);
+
+    BatchResult process(const std::string& input_path);
+
+    // Karşılaştırma için tek iş parçacığında baştan sona
+    BatchResult processSequential(const std::string& input_path);
+};
+
+// Satır başına bir frame: frame,timestamp_us,visible,template,rotation,renk:doluluk;...
+void writeBatchResults(const std::vector<BoardState>& states, std::ostream& out);
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+
+// Düzeltilmiş (warp + rotasyon) tahta görüntüsünün zamansal ortalaması
+struct AccumulatorConfig {
+    bool enabled = false;
+    int classify_interval = 4;      // Patch sınıflandırması her K frame'de bir (hareket sıfırlamasında hemen)
+    bool box = false;               // false: üstel ortalama, true: son box_frames frame'in düz ortalaması
+    int decay_shift = 2;            // Üstel ortalamada yeni frame'in ağırlığı 1 / 2^decay_shift (1..7)
+    int box_frames = 4;             // Kutu ortalamasının uzunluğu (1..64)
+    double motion_threshold = 12.0; // Bir bölgede ortalamaya göre ortalama mutlak fark: aşılırsa sıfırlanır
+};
+
+// Ortalama 16 bit sabit noktalı tutulur; her frame'de tek bir tamsayı geçişiyle (derleyicinin
+// vektörleştirdiği döngü) güncellenir. Okuma (8 bit ortalama) sadece sınıflandırmada yapılır.
+class BoardAccumulator {
+private:
+    AccumulatorConfig config_;
+    cv::Mat sum_;                   // CV_16UC3. Üstel: 8.8 ortalama, kutu: son frame'lerin toplamı
+    std::vector<cv::Mat> ring_;     // Kutu modunda son frame'ler
+    size_t ring_next_ = 0;
+    int frames_ = 0;                // Ortalamadaki frame sayısı (kutu modunda en fazla box_frames)
+    cv::Mat average_;
+
+    uint32_t boxReciprocal() const;
+    double maxRegionDifference(const cv::Mat& board) const;
+
+public:
+    void configure(const AccumulatorConfig& config);
+    void reset();
+
+    // board: CV_8UC3. Dönüş: ortalama sıfırlandı (ilk frame, boyut değişimi veya hareket)
+    bool add(const cv::Mat& board);
+
+    // Gürültüsü azaltılmış tahta (CV_8UC3); bir sonraki add() çağrısına kadar geçerli
+    const cv::Mat& average();
+    int frames() const { return frames_; }
+};
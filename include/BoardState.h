@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Patch renk sınıfları (kablo formatında da bu değerler kullanılır, sırası değişmemeli)
+enum class PatchColor : uint8_t {
+    White = 0,
+    Red,
+    Orange,
+    Yellow,
+    Green,
+    Blue,
+    Purple,
+    Unknown
+};
+
+PatchColor patchColorFromName(const std::string& color_name);
+const char* patchColorName(PatchColor color);
+
+struct PatchState {
+    PatchColor color;
+    float fill_ratio;           // 0.0 - 1.0
+};
+
+// Bir frame'in tahta durumu
+struct BoardState {
+    uint64_t frame_index;
+    int64_t timestamp_us;       // Yakalama zamanı (steady clock, mikrosaniye)
+    bool board_visible;         // false ise patches boştur
+    int template_index;
+    int rotation;
+    std::vector<PatchState> patches;
+};
+
+// Çıktı karşılaştırması (replay / toplu işleme): frame indeksi ve zaman damgası hariç, birebir
+bool sameBoardState(const BoardState& a, const BoardState& b);
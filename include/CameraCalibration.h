@@ -0,0 +1,67 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+// Kamera iç parametreleri ve lens bozulması (OpenCV modeli: k1 k2 p1 p2 [k3 [k4 k5 k6]]).
+// Dosya CameraCalibrate aracının yazdığı YAML / XML'dir: camera_matrix, dist_coeffs,
+// image_width, image_height.
+class CameraCalibration {
+private:
+    cv::Matx33d camera_matrix_;
+    std::vector<double> dist_coeffs_;   // Boş: kalibrasyon yok
+    cv::Size image_size_;
+
+public:
+    CameraCalibration() = default;
+    CameraCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs, cv::Size image_size);
+
+    static CameraCalibration load(const std::string& path);
+    // rms_error >= 0 ise dosyaya bilgi olarak yazılır
+    void save(const std::string& path, double rms_error = -1.0) const;
+
+    bool valid() const { return !dist_coeffs_.empty(); }
+    cv::Size imageSize() const { return image_size_; }
+
+    // Kalibrasyon başka bir çözünürlükte yapıldıysa iç parametreler frame boyutuna ölçeklenir
+    CameraCalibration scaledTo(cv::Size frame_size) const;
+
+    // Bozuk piksel -> bozulmasız (ideal pinhole) piksel, aynı kamera matrisiyle
+    void undistortPoints(std::vector<cv::Point2f>& points) const;
+    // Bozulmasız piksel -> kameranın gördüğü bozuk piksel
+    cv::Point2f distortPoint(double x, double y) const;
+
+    // Frame dışına taşan bozulmasız görüntü dahil, bozulmasız pikselden bozuk piksele tablo.
+    // to_grid: bozulmasız piksel -> tablo koordinatı.
+    void buildDistortionGrid(int step, cv::Mat& grid, cv::Matx33d& to_grid) const;
+};
+
+// Warp pikselinden bozuk frame pikseline remap tablosu. Lens kısmı frame uzayında sabit
+// olduğu için frame boyutu başına bir kez kurulur; köşeler değiştiğinde sadece homografi
+// seyrek örneklere eklenir (perspectiveTransform + remap). Okunan frame bölgesi ve kaydırma
+// da seyrek örneklerde hesaplanır; tam çözünürlükte tek iş doğrusal büyütmedir.
+class DistortionLookup {
+private:
+    cv::Mat grid_;                  // CV_32FC2, DISTORTION_GRID_STEP aralıklı
+    cv::Matx33d to_grid_;
+    cv::Mat coarse_points_;         // Seyrek warp örnekleri (warp boyutu başına)
+    cv::Mat grid_points_;
+    cv::Mat coarse_map_;            // Son composeWarp'ın seyrek tablosu, frame koordinatlarında
+    cv::Mat shifted_map_;
+    cv::Mat fine_map_;
+    cv::Size warp_size_;
+
+public:
+    DistortionLookup() = default;
+    // calibration frame boyutuna ölçeklenmiş olmalı
+    explicit DistortionLookup(const CameraCalibration& calibration);
+
+    bool empty() const { return grid_.empty(); }
+
+    // Homografiyi seyrek örneklere ekler. Dönüş: tablonun okuyacağı frame bölgesi (kapsayıcı,
+    // frame ile kesilmemiş).
+    cv::Rect composeWarp(const cv::Matx33d& warp_to_undistorted, cv::Size warp_size);
+    // Son composeWarp'ın remap tablosu; kaynak görüntü frame'in offset'ten başlayan bölgesidir.
+    // map1: CV_16SC2, map2: CV_16UC1 (cv::convertMaps düzeni).
+    void buildWarpMap(cv::Point offset, cv::Mat& map1, cv::Mat& map2);
+};
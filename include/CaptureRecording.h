@@ -0,0 +1,84 @@
+﻿#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "BoardState.h"
+#include "FrameView.h"
+#include "MappedFile.h"
+
+// Kayıt dosyası (.mrec) düzeni, tüm alanlar little-endian:
+//
+//   [64 byte dosya başlığı]  u32 magic "MREC" | u32 version | 0...
+//   [chunk]...               u32 type | u32 format | u64 payload_size | payload
+//                            format: FRAM için PixelFormat, diğer chunk'larda 0
+//                            Chunk'lar 64 byte sınırında başlar; FRAM verisi de
+//                            64 byte hizalı olduğundan doğrudan cv::Mat'e sarılabilir.
+//   [INDX chunk]             Her frame için FRAM / RSLT ofseti ve zaman damgası
+//   [32 byte footer]         u32 "MEND" | u32 version | u64 index_offset | u64 frame_count | 0
+//
+// Footer yoksa (kayıt yarıda kesildiyse) okuyucu chunk'ları tarayarak indeksi yeniden kurar.
+
+enum class FrameEncoding : uint32_t {
+    Raw = 0,
+    Png = 1     // Kayıpsız
+};
+
+class CaptureRecorder {
+private:
+    std::ofstream file_;
+    std::string path_;
+    bool lossless_compression_;
+    uint64_t offset_;
+
+    struct IndexEntry {
+        uint64_t frame_offset;
+        uint64_t result_offset;     // 0 = sonuç yok
+        int64_t timestamp_us;
+    };
+    std::vector<IndexEntry> index_;
+    std::vector<uchar> encode_buffer_;
+
+    uint64_t writeChunk(uint32_t type, uint32_t format, const std::vector<uint8_t>& header,
+        const uint8_t* data, size_t data_size);
+
+public:
+    CaptureRecorder(const std::string& path, bool lossless_compression);
+    ~CaptureRecorder();
+
+    void writeFrame(const FrameView& frame, int64_t timestamp_us);
+
+    // Son yazılan frame'in dedektör sonucu
+    void writeResult(const BoardState& state);
+
+    void close();
+
+    size_t frameCount() const { return index_.size(); }
+};
+
+class CaptureReplay {
+private:
+    struct Entry {
+        const uint8_t* frame_chunk;
+        const uint8_t* result_chunk;    // nullptr = sonuç yok
+        int64_t timestamp_us;
+    };
+
+    std::unique_ptr<MappedFile> file_;
+    std::vector<Entry> entries_;
+
+    bool loadIndex();
+    void scanChunks();
+
+public:
+    explicit CaptureReplay(const std::string& path);
+
+    size_t frameCount() const { return entries_.size(); }
+    int64_t timestamp(size_t index) const { return entries_[index].timestamp_us; }
+
+    // Ham frame'ler kopyalanmadan eşlenmiş belleğe sarılır
+    bool readFrame(size_t index, FrameView& frame, int64_t& timestamp_us) const;
+    bool readResult(size_t index, BoardState& state) const;
+};
@@ -1,10 +1,24 @@
 #pragma once
-#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+#include <opencv2/core.hpp>
 
 struct ColorDetectionResult {
     cv::Scalar color;           // Tespit edilen renk (BGR)
     std::string color_name;     // Renk ad ("Red", "Blue", vs.)
     float fill_ratio;           // Doluluk oran (0.0 - 1.0)
+    int pixels_visited = 0;     // Karar iin incelenen piksel says
+    int pixels_total = 0;       // Maskedeki toplam piksel says
+};
+
+// rneklemeli snflandrma ayarlar
+struct SamplingConfig {
+    bool enabled = true;            // false: her piksel saylr (tam sonu)
+    float fill_error = 0.02f;       // Doluluk oran iin kabul edilen hata ()
+    float confidence_z = 2.58f;     // Gven aral katsays (~%99)
+    int min_samples = 64;           // lk testten nce baklacak piksel says
+    int batch_size = 32;            // Testler aras piksel says
+    float min_fill_ratio = 0.0f;    // Beyaz kararnn verildii doluluk eii
 };
 
 class ColorDetector {
@@ -20,11 +34,20 @@ private:
     bool isBlue(int h, int b, int r, int g) const;
     bool isPurple(int h, int r, int g, int b) const;
 
-    std::string getColorName(const cv::Scalar& color) const;
+    enum ColorClass { RED = 0, ORANGE, YELLOW, GREEN, BLUE, PURPLE, COLOR_CLASS_COUNT };
+    using ColorCounts = std::array<int, COLOR_CLASS_COUNT>;
+
+    // -1: beyaz/gri veya ok koyu, aksi halde ColorClass
+    int classifyPixel(const cv::Vec3b& hsv, const cv::Vec3b& bgr) const;
+    // threshold = max(3, non_white / 15) kural ile baskn renk
+    cv::Scalar pickDominant(const ColorCounts& counts, int non_white_pixels) const;
 
 public:
     ColorDetector(int min_val = 40, int max_val = 240, int min_sat = 50);
 
+    // Snf rengini (BGR) adna evirir; ColorHistory'nin kararl rengi iin de kullanlr
+    std::string getColorName(const cv::Scalar& color) const;
+
     // Eski fonksiyon - geriye uyumluluk
     cv::Scalar detectDominantColor(const cv::Mat& roi_bgr,
         const cv::Mat& roi_hsv,
@@ -34,4 +57,10 @@ public:
     ColorDetectionResult detectColorWithRatio(const cv::Mat& roi_bgr,
         const cv::Mat& roi_hsv,
         const cv::Mat& mask) const;
+
+    // Pikselleri verilen srada (PatchSampler) gezer; doluluk oran ve baskn renk
+    // istenen hata snrnda belirlendiinde durur. HSV sadece gezilen pikseller iin hesaplanr.
+    ColorDetectionResult detectColorSampled(const cv::Mat& frame_bgr,
+        const std::vector<cv::Point>& sample_points,
+        const SamplingConfig& config) const;
 };
\ No newline at end of file
@@ -1,15 +1,34 @@
-#pragma once
+﻿#pragma once
+#include <cstdint>
 #include <vector>
 #include <map>
-#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
 
+// Yakalama zamanıyla birlikte bir renk gözlemi
+struct ColorSample {
+    cv::Scalar color;
+    int64_t timestamp_us;
+
+    bool operator==(const ColorSample& other) const {
+        return color == other.color && timestamp_us == other.timestamp_us;
+    }
+};
+
+// Son window_ms içindeki gözlemlerden zamana göre ağırlıklı oylama. Her gözlem bir önceki
+// gözlemden bu yana geçen süreyi temsil eder (atlanan frame'ler ağırlığa yansır), eski
+// gözlemlerin ağırlığı üstel olarak azalır. Böylece sonuç işlenen frame hızından bağımsızdır.
 class ColorHistory {
 private:
-    std::vector<cv::Scalar> recent_colors_;
-    size_t max_history_;
+    std::vector<ColorSample> recent_colors_;
+    int64_t window_us_;
+    size_t max_samples_;
 public:
-    explicit ColorHistory(size_t max_history = 7);
-    void addColor(const cv::Scalar& color);
+    explicit ColorHistory(int window_ms = 250);
+    void addColor(const cv::Scalar& color, int64_t timestamp_us);
     cv::Scalar getStableColor() const;
     void clear();
-};
\ No newline at end of file
+
+    // Toplu işlemede durum karşılaştırma / aktarma için
+    const std::vector<ColorSample>& getSamples() const;
+    void setSamples(const std::vector<ColorSample>& samples);
+};
@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "PatchInfo.h"
+#include "TemplateProcessor.h"
+
+// Dijital mozaiği label haritası üzerinden çizer.
+// Label haritası ve çizgi maskesi çıktı boyutu + rotasyon için bir kez hazırlanır,
+// sonraki frame'lerde sadece durumu değişen patch'ler yeniden boyanır.
+class DigitalRenderer {
+private:
+    struct Sprite {
+        cv::Mat alpha;          // Yazının kapsama maskesi (0-255)
+        cv::Size text_size;     // getTextSize sonucu
+    };
+
+    const TemplateProcessor* template_processor_;
+
+    cv::Size cached_size_;
+    int cached_rotation_;
+    bool valid_;
+
+    cv::Mat labels_;                        // CV_16U: 0 = arka plan, i+1 = patch, line_label_ = çizgi
+    cv::Mat canvas_;                        // Son çizilen çıktı (CV_8UC3)
+    ushort line_label_;
+
+    std::vector<cv::Vec3b> palette_;        // label -> renk
+    std::vector<cv::Rect> patch_bounds_;    // Patch'lerin label haritasındaki sınırları
+    std::vector<int> drawn_sprites_;        // Patch başına çizili yüzde (-1 = yok)
+    std::vector<cv::Point> sprite_origins_; // Sprite'ın sol üst köşesi
+
+    std::vector<Sprite> sprites_;           // %0 - %100 için önceden çizilmiş yazılar
+
+    void buildSprites();
+    void rebuildLabelMap(cv::Size size, int rotation);
+
+    cv::Rect spriteRect(int patch_index) const;
+    void paintRegion(const cv::Rect& region);
+    void blitSprite(int patch_index, const cv::Rect& clip);
+    void redrawRegion(const cv::Rect& region);
+
+public:
+    explicit DigitalRenderer(const TemplateProcessor& template_processor);
+
+    // Dönen görüntü bir sonraki render() çağrısına kadar geçerlidir
+    const cv::Mat& render(cv::Size size, int rotation,
+        const std::vector<PatchInfo>& patch_infos);
+
+    void invalidate();
+};
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "CaptureRecording.h"
+#include "FrameView.h"
+#include "SharedFrameRing.h"
+
+// Kamera giriş yolu
+enum class CaptureFormat {
+    BGR,        // OpenCV'nin dönüştürdüğü BGR (varsayılan)
+    Native,     // YUYV / NV12 tampon dönüştürülmeden
+    MJPEG       // Sıkıştırılmış frame: marker tespiti küçültülmüş decode, renkler tahta bölgesinden
+};
+
+struct CaptureConfig {
+    int width = 1280;
+    int height = 720;
+    CaptureFormat format = CaptureFormat::BGR;
+    int mjpeg_detection_scale = 2;      // 1, 2, 4 veya 8 (JPEG DCT ölçeklemesi)
+};
+
+// Dedektöre frame sağlayan kaynak. read()'in verdiği görünüm kaynağın belleğine
+// sarılı olabilir ve bir sonraki read() çağrısına kadar geçerlidir.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // false: akış bitti
+    virtual bool read(FrameView& frame, int64_t& timestamp_us) = 0;
+
+    // Çözünürlük ve giriş yolu; formatı frame ile birlikte gelen kaynaklarda etkisiz
+    virtual void configure(const CaptureConfig& /*config*/) {}
+
+    // Tüketici yetişemediği için kaynakta atlanan frame sayısı (bilinmiyorsa 0)
+    virtual uint64_t droppedFrames() const { return 0; }
+};
+
+// cv::VideoCapture: kamera veya video dosyası
+class VideoCaptureSource : public FrameSource {
+private:
+    cv::VideoCapture capture_;
+    CaptureConfig config_;
+    bool is_camera_;
+    cv::Mat raw_;
+
+public:
+    VideoCaptureSource(int camera_index, const CaptureConfig& config);
+    explicit VideoCaptureSource(const std::string& video_path);
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override;
+    void configure(const CaptureConfig& config) override;
+};
+
+// .mrec kaydı, sırayla; realtime ise kayıttaki zamanlamayla
+class ReplaySource : public FrameSource {
+private:
+    CaptureReplay replay_;
+    bool realtime_;
+    size_t next_ = 0;
+    size_t last_index_ = 0;
+    std::chrono::steady_clock::time_point wall_start_;
+
+public:
+    ReplaySource(const std::string& path, bool realtime);
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override;
+
+    const CaptureReplay& replay() const { return replay_; }
+    // Son okunan frame'in kayıttaki indeksi
+    size_t lastIndex() const { return last_index_; }
+};
+
+// Başka bir sürecin paylaşımlı bellek halkasına yazdığı frame'ler, kopyalanmadan.
+// Üretici kapanınca veya timeout_ms boyunca yeni frame gelmezse akış biter.
+class SharedMemoryFrameSource : public FrameSource {
+private:
+    SharedFrameReader reader_;
+    int timeout_ms_;
+    uint64_t frames_ = 0;
+
+public:
+    explicit SharedMemoryFrameSource(const std::string& name, int timeout_ms = 5000);
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override;
+
+    uint64_t framesRead() const { return frames_; }
+    uint64_t droppedFrames() const override { return reader_.dropped(); }
+};
+
+int64_t steadyTimestampUs();
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+// Kameranın verdiği piksel düzeni
+enum class PixelFormat : uint32_t {
+    BGR = 0,    // HxW CV_8UC3
+    Gray = 1,   // HxW CV_8UC1
+    YUYV = 2,   // HxW CV_8UC2 (Y0 U Y1 V)
+    NV12 = 3,   // (H*3/2)xW CV_8UC1: Y düzlemi + iç içe UV düzlemi
+    MJPEG = 4   // 1xN CV_8UC1 sıkıştırılmış JPEG; boyutlar JPEG başlığından
+};
+
+// Sahiplenmeyen frame görünümü: veri kopyalanmaz, sadece formatı ile birlikte taşınır
+struct FrameView {
+    PixelFormat format;
+    cv::Mat data;
+    int width;
+    int height;
+};
+
+FrameView makeFrameView(const cv::Mat& data, PixelFormat format);
+
+// Çağıranın tamponuna kopyasız sarılı görünüm. stride: satır başına bayt (0: boşluksuz).
+// NV12'de UV düzlemi Y düzleminin hemen ardından aynı stride ile gelir.
+FrameView wrapFrame(const void* data, int width, int height, size_t stride, PixelFormat format);
+
+// Sıkıştırılmış JPEG baytlarına kopyasız sarılı MJPEG görünümü
+FrameView wrapJpegFrame(const void* data, size_t size);
+
+// Ham capture tamponunu (CAP_PROP_CONVERT_RGB = 0) fourcc'ye göre yorumla
+FrameView wrapNativeFrame(const cv::Mat& raw, int fourcc, int width, int height);
+
+// Marker tespiti için parlaklık düzlemi (NV12 / Gray için kopyasız, MJPEG'de tam gri decode)
+cv::Mat lumaPlane(const FrameView& frame);
+
+// Sadece verilen bölgeyi BGR'ye çevir (YUV'de bölge çift koordinatlara genişletilir).
+// offset, dönen görüntünün frame'deki sol üst köşesidir.
+void convertRegionToBGR(const FrameView& frame, const cv::Rect& region,
+    cv::Mat& bgr, cv::Point& offset);
+
+void convertToBGR(const FrameView& frame, cv::Mat& bgr);
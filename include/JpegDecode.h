@@ -0,0 +1,18 @@
+﻿#pragma once
+#include <opencv2/core.hpp>
+
+// MJPEG frame'leri için kısmi / küçültülmüş JPEG decode.
+// jpeg: 1xN CV_8UC1 sıkıştırılmış baytlar (CAP_PROP_CONVERT_RGB = 0 ile MJPG kamera çıktısı).
+
+// SOF başlığından boyutları okur
+bool readJpegSize(const cv::Mat& jpeg, cv::Size& size);
+
+// DCT ölçeklemesiyle 1/scale boyutunda gri decode (scale: 1, 2, 4 veya 8).
+// Tam çözünürlüklü decode + resize'dan çok daha ucuzdur.
+cv::Mat decodeJpegReducedGray(const cv::Mat& jpeg, int scale);
+
+// Sadece region'ı kapsayan bölgeyi tam çözünürlükte BGR olarak decode eder.
+// MOSAIC_WITH_LIBJPEG_TURBO ile region dışındaki satırlar atlanır ve sütunlar MCU sınırına
+// kırpılır; aksi halde tam decode edilip bölge alınır. offset: bgr'nin frame'deki sol üst köşesi.
+void decodeJpegRegion(const cv::Mat& jpeg, const cv::Rect& region,
+    cv::Mat& bgr, cv::Point& offset);
@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Dosyayı copy-on-write olarak belleğe eşler: okunan veriye cv::Mat başlığı
+// sarılabilir, yazılırsa dosya değişmez.
+class MappedFile {
+private:
+    uint8_t* data_;
+    size_t size_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+};
@@ -1,12 +1,12 @@
-#pragma once
+﻿#pragma once
 #include <vector>
-#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
 #include <opencv2/aruco.hpp>
 
 class MarkerDetector {
 private:
     cv::aruco::ArucoDetector detector_;
-    int target_marker_id_;
+    std::vector<int> target_marker_ids_;    // Tahta köşelerinde kullanılabilecek ID'ler (öncelik sırasıyla)
 
     cv::Point2f getMarkerCenter(const std::vector<cv::Point2f>& corners) const;
 
@@ -14,9 +14,16 @@ public:
     MarkerDetector(int target_id, const cv::aruco::Dictionary& dictionary,
         const cv::aruco::DetectorParameters& params);
 
+    // Her template'in kendi marker ID'si varsa hepsi hedeflenir
+    void setTargetIds(const std::vector<int>& ids);
+
     bool detectMarkers(const cv::Mat& frame,
         std::vector<std::vector<cv::Point2f>>& target_corners);
 
+    // Hedef ID'lerden biri tam dört kez görülürse true; board_id o ID'dir
+    bool detectMarkers(const cv::Mat& frame,
+        std::vector<std::vector<cv::Point2f>>& target_corners, int& board_id);
+
     std::vector<cv::Point2f> orderCorners(
         const std::vector<std::vector<cv::Point2f>>& markers) const;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SharedMemoryRegion.h"
+
+// Paylaşımlı bellekte tek yazar / çok okuyuculu, kilitsiz mesaj halkası.
+// Her slot bir sıra numarası taşır (seqlock): yazar hiçbir zaman beklemez,
+// geride kalan okuyucu üzerine yazılan mesajları kaybettiğini fark eder.
+struct MessageRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;                     // Slot başına en fazla payload
+    std::atomic<uint64_t> write_sequence;   // Yayınlanan mesaj sayısı
+};
+
+struct MessageRingSlot {
+    std::atomic<uint64_t> state;            // 2*seq+1: yazılıyor, 2*seq+2: hazır
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+    "Shared memory ring requires lock-free 64-bit atomics");
+
+class MessageRingWriter {
+private:
+    std::unique_ptr<SharedMemoryRegion> region_;
+    MessageRingHeader* header_;
+    uint8_t* slots_;
+    size_t slot_stride_;
+    uint64_t next_sequence_;
+
+public:
+    MessageRingWriter(const std::string& name, size_t slot_count, size_t slot_size);
+
+    // Mesaj slot'a sığmıyorsa false döner
+    bool write(const uint8_t* data, size_t size);
+
+    size_t slotSize() const { return header_->slot_size; }
+    uint64_t written() const { return next_sequence_; }
+};
+
+enum class RingReadResult {
+    Message,
+    Empty,
+    Overrun     // Okuyucu geride kaldı, arada mesaj kaybedildi
+};
+
+class MessageRingReader {
+private:
+    std::unique_ptr<SharedMemoryRegion> region_;
+    const MessageRingHeader* header_;
+    const uint8_t* slots_;
+    size_t slot_stride_;
+    uint64_t next_sequence_;
+
+public:
+    // Okuyucu bağlandığı andan sonra yazılan mesajlardan başlar
+    explicit MessageRingReader(const std::string& name);
+
+    RingReadResult read(std::vector<uint8_t>& out);
+
+    uint64_t nextSequence() const { return next_sequence_; }
+};
@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include "MetricsRegistry.h"
+
+// Soket ve thread içerdiği için MosaicEngine'e değil, ayrı MosaicMetricsExporter kütüphanesine
+// derlenir. Motoru gömen servis bunun yerine MetricsRegistry::renderPrometheus / renderJson
+// çıktısını kendi sunucusundan verebilir.
+
+struct MetricsConfig {
+    int http_port = 0;                  // 0: HTTP kapalı (GET /metrics, Prometheus metin formatı)
+    std::string http_address = "127.0.0.1";
+    std::string json_path;              // Boş değilse periyodik olarak JSON yazılır
+    int json_interval_ms = 1000;
+    int window_seconds = 60;            // Oran ve yüzdelik değerlerinin hesaplandığı pencere
+};
+
+// Registry'yi kendi thread'inde HTTP üzerinden sunar ve/veya JSON dosyasına yazar
+class MetricsExporter {
+private:
+    MetricsRegistry& registry_;
+    MetricsConfig config_;
+    std::atomic<bool> stop_{ false };
+    std::thread thread_;
+    int server_socket_ = -1;
+
+    void openSocket();
+    void serveClients(int timeout_ms);
+    void writeJson();
+    void loop();
+
+public:
+    MetricsExporter(MetricsRegistry& registry, const MetricsConfig& config);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+};
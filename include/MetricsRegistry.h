@@ -0,0 +1,137 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Frame döngüsünden güncellenen sayaç / ölçü / dağılım metrikleri. Güncellemeler
+// sadece relaxed atomik işlemlerdir (kilit yok); okuma ve dışa aktarma ayrı thread'de.
+
+class MetricCounter {
+private:
+    std::atomic<uint64_t> value_{ 0 };
+
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+class MetricGauge {
+private:
+    std::atomic<double> value_{ 0.0 };
+
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+};
+
+// Tam sayı gözlemler (gecikmede mikrosaniye) için logaritmik kovalar: her ikinin
+// kuvveti 4 kovaya bölünür (~%19 çözünürlük), 0 - ~33 s arası.
+class MetricHistogram {
+public:
+    static const int BUCKET_COUNT = 96;
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_{ 0 };
+
+public:
+    void observe(uint64_t value);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t bucket(int index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketLowerBound(int index);
+};
+
+// Bir önceki tura göre geçen süre (mikrosaniye) dağılıma yazılır ve döndürülür
+class MetricTimer {
+private:
+    std::chrono::steady_clock::time_point last_;
+
+public:
+    MetricTimer() : last_(std::chrono::steady_clock::now()) {}
+
+    uint64_t lap(MetricHistogram& histogram) {
+        auto now = std::chrono::steady_clock::now();
+        uint64_t elapsed_us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - last_).count());
+        histogram.observe(elapsed_us);
+        last_ = now;
+        return elapsed_us;
+    }
+};
+
+class MetricsRegistry {
+public:
+    enum class Type { Counter, Gauge, Histogram, Rate, Ratio };
+
+private:
+    struct Entry {
+        Type type;
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> labels;
+        std::string help;
+        double scale = 1.0;             // Dağılımda gözlem birimi -> dışa aktarılan birim
+        MetricCounter* counter = nullptr;
+        MetricGauge* gauge = nullptr;
+        MetricHistogram* histogram = nullptr;
+        MetricCounter* denominator = nullptr;
+    };
+
+    // Pencere başındaki değerler (oranlar ve yüzdelikler pencere farkından hesaplanır)
+    struct Snapshot {
+        std::chrono::steady_clock::time_point time;
+        std::vector<uint64_t> counters;
+        std::vector<std::vector<uint64_t>> histograms;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<std::unique_ptr<MetricCounter>> counters_;
+    std::vector<std::unique_ptr<MetricGauge>> gauges_;
+    std::vector<std::unique_ptr<MetricHistogram>> histograms_;
+
+    mutable std::mutex mutex_;          // Sadece kayıt ve dışa aktarma; güncellemeler kilitsiz
+    std::deque<Snapshot> snapshots_;
+    std::chrono::steady_clock::time_point created_;
+
+    Snapshot takeSnapshot() const;
+    const Snapshot* windowStart() const;
+    double windowValue(const Entry& entry, const Snapshot* start,
+        std::chrono::steady_clock::time_point now) const;
+    double quantile(const Entry& entry, const Snapshot* start, double q) const;
+
+public:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Kayıt frame döngüsü başlamadan yapılır; dönen referanslar registry ile yaşar.
+    // labels: "stage=markers" veya "a=1,b=2"
+    MetricCounter& addCounter(const std::string& name, const std::string& help,
+        const std::string& labels = "");
+    MetricGauge& addGauge(const std::string& name, const std::string& help,
+        const std::string& labels = "");
+    MetricHistogram& addHistogram(const std::string& name, const std::string& help,
+        const std::string& labels = "", double scale = 1.0);
+    // Pencere içindeki artış / saniye
+    void addRate(const std::string& name, const std::string& help, const MetricCounter& counter);
+    // Pencere içindeki artışların oranı (pay / payda)
+    void addRatio(const std::string& name, const std::string& help,
+        const MetricCounter& numerator, const MetricCounter& denominator);
+
+    // Pencereyi ilerletir (dışa aktaran thread periyodik olarak çağırır)
+    void tick(int window_seconds);
+
+    std::string renderPrometheus() const;
+    std::string renderJson() const;
+};
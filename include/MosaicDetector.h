@@ -1,74 +1,93 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
 #include <opencv2/opencv.hpp>
-#include "MarkerDetector.h"
-#include "TemplateProcessor.h"
-#include "ColorDetector.h"
-#include "ColorHistory.h"
-
-struct PatchInfo {
-    int patch_id;
-    std::string color_name;
-    float fill_ratio;
-    cv::Point centroid;
-};
+#include "MosaicEngine.h"
+#include "ResultPublisher.h"
+#include "CaptureRecording.h"
+#include "FrameView.h"
+#include "FrameSource.h"
+#include "MetricsExporter.h"
 
+// Uygulama: frame kayna, pencereler, kayt ve sonu yayn. Tespitin kendisi MosaicEngine'de.
 class MosaicDetector {
 private:
-    std::unique_ptr<MarkerDetector> marker_detector_;
-    std::unique_ptr<ColorDetector> color_detector_;
+    MosaicEngine engine_;
 
-    // oklu template destei
-    std::vector<std::unique_ptr<TemplateProcessor>> template_processors_;
-    std::vector<std::string> template_paths_;
-    std::vector<std::string> template_names_;
-    int current_template_index_;
-    int detected_template_index_;
-    int template_vote_count_;
-
-    std::vector<std::vector<ColorHistory>> all_color_histories_;
-    std::vector<std::vector<float>> all_ratio_histories_;
-
-    cv::VideoCapture camera_;
+    std::unique_ptr<FrameSource> source_;
+    CaptureConfig capture_config_;
     bool is_running_;
 
-    // Rotasyon takibi
-    int current_rotation_;
-    int rotation_vote_count_ = 0;
-
-    void initializeWindows();
-    void switchTemplate(int index);
-    void resetHistories(int index);
-
-    cv::Mat applyPerspectiveTransform(const cv::Mat& frame,
-        const std::vector<cv::Point2f>& src_points);
+    // Headless modda (benchmark, toplu ileme) pencere almaz, dijital kt izilmez
+    bool display_enabled_ = true;
+    bool windows_initialized_ = false;
 
-    cv::Mat generateDigitalOutput(const cv::Mat& warped_frame,
-        std::vector<PatchInfo>& patch_infos);
+    // Sonu yayn
+    std::unique_ptr<ResultPublisher> publisher_;
+    BoardState last_state_;
 
-    void drawRatioInfo(cv::Mat& image, const std::vector<PatchInfo>& patch_infos);
-    cv::Point calculateContourCentroid(const std::vector<cv::Point>& contour);
+    std::unique_ptr<CaptureRecorder> recorder_;
 
-    // Rotasyon fonksiyonlar
-    int detectRotation(const std::vector<std::vector<cv::Point2f>>& markers);
-    cv::Mat rotateImage(const cv::Mat& image, int rotation);
-    cv::Mat rotateImageInverse(const cv::Mat& image, int rotation);
+    // Kaynak ve uygulama taraf metrikleri (motorun kaydna eklenir)
+    MetricCounter* metric_frames_captured_;
+    MetricCounter* metric_frames_dropped_;
+    MetricHistogram* metric_publish_latency_;
+    MetricHistogram* metric_display_latency_;
+    uint64_t source_dropped_seen_ = 0;
+    std::unique_ptr<MetricsExporter> metrics_exporter_;
+    void readFrameSourceMetrics();
 
-    // Otomatik template alglama
-    int detectTemplate(const cv::Mat& warped_normalized);
-    double calculateTemplateSimilarity(const cv::Mat& warped_lines, int template_index);
+    void initializeWindows();
+    void showFrame(bool board_found);
 
 public:
     MosaicDetector(const std::vector<std::string>& template_paths,
         const std::vector<std::string>& template_names,
         int target_marker_id = 23,
-        int camera_index = 0);
+        int camera_index = 0);     // < 0: kamera almaz (setFrameSource veya processFrame ile beslenir)
 
     ~MosaicDetector();
 
     void run();
+
+    // Kayd processFrame'den geirir, sonular kayttakilerle birebir aynysa true
+    bool runReplay(const std::string& path, bool realtime);
+
     void processFrame(cv::Mat& frame);
+    void processFrame(cv::Mat& frame, int64_t timestamp_us);
+    void processFrame(const FrameView& frame, int64_t timestamp_us);
     void stop();
+
+    void enableResultPublishing(const PublisherConfig& config);
+    void setDisplayEnabled(bool enabled);
+    // enabled = false: her patch'in tm pikselleri saylr
+    void setSamplingConfig(const SamplingConfig& config);
+    // Kamera znrl ve giri yolu (kamera ak deilse sadece ileme ayarlar)
+    void configureCapture(const CaptureConfig& config);
+    // run()'n frame ald kaynak (kamerann yerine geer)
+    void setFrameSource(std::unique_ptr<FrameSource> source);
+    // Bkz. MosaicEngine::setTemplateMarkerIds
+    void setTemplateMarkerIds(const std::vector<int>& marker_ids);
+    // Tahta grnmezken dk gl tarama (bkz. IdleConfig); botayken pencereler
+    // sadece tarama yaplan frame'lerde gncellenir
+    void setIdleConfig(const IdleConfig& config);
+    // Tahta uzaynda zamansal ortalama ve seyrek snflandrma (bkz. AccumulatorConfig)
+    void setAccumulatorConfig(const AccumulatorConfig& config);
+    // Lens bozulmas dzeltmesi (bkz. CameraCalibration)
+    void setCalibration(const CameraCalibration& calibration);
+    void enableRecording(const std::string& path, bool lossless_compression);
+    // Metrikleri HTTP (Prometheus) ve/veya JSON dosyas olarak da aktarr
+    void enableMetrics(const MetricsConfig& config);
+    MetricsRegistry& metrics() { return engine_.metrics(); }
+
+    MosaicEngine& engine() { return engine_; }
+
+    // Son ilenen frame'in sonucu
+    const BoardState& getLastState() const;
+
+    // Toplu ileme: segmentler aras durum karlatrma ve aktarma
+    DetectorState getState() const;
+    void setState(const DetectorState& state);
 };
\ No newline at end of file
@@ -0,0 +1,261 @@
+﻿#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "BoardAccumulator.h"
+#include "BoardState.h"
+#include "CameraCalibration.h"
+#include "ColorDetector.h"
+#include "ColorHistory.h"
+#include "DigitalRenderer.h"
+#include "FrameView.h"
+#include "MarkerDetector.h"
+#include "MetricsRegistry.h"
+#include "PatchInfo.h"
+#include "PatchSampler.h"
+#include "TemplateProcessor.h"
+
+// Sonraki frame'lerin çıktısını etkileyen zamansal durum (oylamalar + tüm template'lerin
+// renk geçmişi; template'e geri dönüldüğünde onun geçmişi kullanılır). Oran geçmişi her
+// frame'de baştan yazıldığı için dahil değildir.
+// Oylar frame sayısı değil, yakalama zamanına göre biriken gözlem süresidir (mikrosaniye).
+struct DetectorState {
+    int current_template_index = 0;
+    int detected_template_index = 0;
+    int64_t template_vote_us = 0;
+    int current_rotation = 0;
+    int64_t rotation_vote_us = 0;
+    int64_t last_observation_us = -1;                       // Tahtanın son görüldüğü frame (-1: hiç)
+    std::vector<std::vector<std::vector<ColorSample>>> color_samples;  // Template, patch başına
+
+    bool operator==(const DetectorState& other) const;
+    bool operator!=(const DetectorState& other) const { return !(*this == other); }
+};
+
+// Tahta uzun süre görünmezken düşük güçlü tarama. Boşta modunda marker araması düşük
+// çözünürlükte ve seyrek yapılır: hareket görülürse hemen, görülmezse her boş taramada
+// iki katına çıkan aralıklarla. Tahta bulunduğu frame tam olarak işlenir.
+struct IdleConfig {
+    bool enabled = false;
+    int idle_after_frames = 90;         // Bu kadar ardışık frame tahta görülmezse boşta moduna geçilir
+    int scan_scale = 2;                 // Boşta marker araması 1/scan_scale çözünürlükte (1, 2, 4 veya 8)
+    int min_scan_interval_ms = 50;      // Hareketten sonraki tarama aralığı (30 fps'te ~2 frame)
+    int max_scan_interval_ms = 2000;    // Hareketsiz sahnede aralığın üst sınırı
+    double motion_threshold = 6.0;      // Son taramaya göre ortalama mutlak parlaklık farkı
+};
+
+// Son frame'in ara görüntüleri (görselleştirme için, setKeepImages(true) ile dolar)
+struct EngineImages {
+    cv::Mat detection_image;            // Marker aranan gri görüntü (frame belleğine sarılı olabilir)
+    int detection_scale = 1;            // detection_image = frame / detection_scale
+    std::vector<cv::Point2f> corners;   // Sıralı tahta köşeleri, tam çözünürlükte (tahta yoksa boş)
+    cv::Mat warped;                     // Düzeltilmiş tahta, rotasyon geri alınmadan
+};
+
+// Mozaik tespit çekirdeği: frame'i alır, tahta durumunu çağıranın BoardState'ine yazar.
+// Kamera, pencere veya sonuç yayını bağımlılığı yoktur; frame kopyalanmadan işlenir.
+// Tek thread'den kullanılmalıdır (metrikler hariç).
+class MosaicEngine {
+private:
+    std::unique_ptr<MarkerDetector> marker_detector_;
+    std::unique_ptr<ColorDetector> color_detector_;
+
+    // Çoklu template desteği
+    std::vector<std::unique_ptr<TemplateProcessor>> template_processors_;
+    std::vector<std::unique_ptr<DigitalRenderer>> renderers_;
+    std::vector<std::unique_ptr<PatchSampler>> samplers_;
+    std::vector<std::string> template_names_;
+    int current_template_index_;
+    int detected_template_index_;
+    int64_t template_vote_us_;
+
+    // Template kimliği marker ID'sinde: ID -> template indeksi (boşsa görüntüden tanıma)
+    int target_marker_id_;
+    std::map<int, int> marker_templates_;
+    uint64_t marker_template_frames_ = 0;
+    uint64_t template_check_mismatches_ = 0;
+    void applyMarkerTemplate(int board_id, int template_index, const cv::Mat& warped_normalized);
+
+    std::vector<std::vector<ColorHistory>> all_color_histories_;
+    std::vector<std::vector<float>> all_ratio_histories_;
+
+    // Rotasyon takibi
+    int current_rotation_;
+    int64_t rotation_vote_us_ = 0;
+
+    // Oylamada bu frame'in temsil ettiği süre: önceki gözlemden bu yana geçen zaman
+    int64_t last_observation_us_ = -1;
+    int64_t observationSpan(int64_t timestamp_us);
+
+    uint64_t frame_counter_ = 0;
+    int mjpeg_detection_scale_ = 2;
+
+    // Boşta modu: durum, tarama zamanlaması ve hareket referansı (1/8 gri küçük görüntü)
+    IdleConfig idle_config_;
+    bool idle_ = false;
+    bool marker_search_ran_ = true;
+    int frames_without_board_ = 0;
+    int64_t idle_scan_interval_us_ = 0;
+    int64_t next_idle_scan_us_ = 0;
+    int64_t last_idle_scan_us_ = 0;
+    cv::Mat motion_thumbnail_;
+    cv::Mat motion_reference_;
+    void enterIdle(int64_t timestamp_us);
+    bool detectMotion(const FrameView& frame);
+    bool scanIdle(const FrameView& frame, int64_t timestamp_us);
+
+    // Durumlarda geçen süre (yakalama zamanı) ve boşta modunun kazandırdığı işlem süresi:
+    // aktif modda tahtasız bir frame'in ortalama maliyeti - boştaki frame'in gerçek maliyeti
+    int64_t last_frame_us_ = -1;
+    double state_seconds_[2] = { 0.0, 0.0 };
+    uint64_t state_frames_[2] = { 0, 0 };
+    double active_miss_cost_us_ = 0.0;
+    double idle_saved_us_ = 0.0;
+    void accountFrame(int64_t timestamp_us, bool was_idle, bool found, uint64_t cost_us);
+
+    // Lens bozulması: marker köşeleri nokta olarak düzeltilir, bozulma ve homografi tek
+    // remap tablosunda birleşir. Lens tablosu frame boyutu başına bir kez kurulur, homografi
+    // köşeler değiştikçe ona eklenir.
+    CameraCalibration calibration_;
+    CameraCalibration frame_calibration_;       // Frame boyutuna ölçeklenmiş
+    DistortionLookup distortion_lookup_;
+    std::vector<cv::Point2f> warp_map_corners_; // Tablonun kurulduğu köşeler
+    int warp_map_size_ = 0;
+    cv::Rect warp_map_region_;                  // Tablonun okuduğu frame bölgesi (BGR dışı formatlarda)
+    cv::Mat warp_map_fixed_;                    // remap için sabit noktalı tablo (CV_16SC2 + CV_16UC1),
+    cv::Mat warp_map_fraction_;                 // warp_map_offset_'e göre kaydırılmış
+    cv::Point warp_map_offset_;
+    void updateFrameCalibration(cv::Size frame_size);
+    cv::Mat extractBoardUndistorted(const FrameView& frame, const std::vector<cv::Point2f>& corners,
+        int warp_size);
+
+    // Tahta uzayında zamansal ortalama: sınıflandırma ortalama üzerinde, K frame'de bir.
+    // Warp boyutu küçük titreşimlerde sabit tutulur (boyut değişimi ortalamayı sıfırlar).
+    AccumulatorConfig accumulator_config_;
+    BoardAccumulator accumulator_;
+    int accumulated_template_ = -1;
+    int accumulated_rotation_ = -1;
+    int frames_since_classify_ = 0;
+    int held_warp_size_ = 0;
+    int stableWarpSize(int warp_size);
+
+    // Son frame'in patch ayrıntıları ve (istenirse) ara görüntüleri
+    std::vector<PatchInfo> patch_infos_;
+    cv::Size last_warp_size_;
+    bool keep_images_ = false;
+    EngineImages images_;
+
+    // Örneklemeli renk sınıflandırması
+    SamplingConfig sampling_config_;
+    uint64_t stats_pixels_visited_ = 0;
+    uint64_t stats_pixels_total_ = 0;
+
+    // Canlı metrikler: frame işleme sadece atomik güncelleme yapar
+    enum MetricStage { STAGE_INPUT, STAGE_MARKERS, STAGE_WARP, STAGE_TEMPLATE, STAGE_ACCUMULATE,
+        STAGE_CLASSIFY, STAGE_IDLE, STAGE_TOTAL, STAGE_COUNT };
+    MetricsRegistry metrics_;
+    MetricCounter* metric_frames_processed_;
+    MetricCounter* metric_frames_idle_;         // Boşta tam tespite girmeyen (payda dışı)
+    MetricCounter* metric_board_found_;
+    MetricCounter* metric_template_switches_;
+    MetricCounter* metric_rotation_changes_;
+    MetricHistogram* metric_patches_changed_;
+    MetricHistogram* metric_stage_latency_[STAGE_COUNT];
+    MetricGauge* metric_template_index_;
+    MetricGauge* metric_rotation_;
+    MetricGauge* metric_patch_count_;
+    MetricGauge* metric_idle_;
+    MetricGauge* metric_state_seconds_[2];
+    MetricGauge* metric_idle_saved_seconds_;
+    MetricCounter* metric_idle_scans_;
+    MetricCounter* metric_idle_entries_;
+    MetricCounter* metric_distortion_lookups_;
+    MetricCounter* metric_classifications_;
+    MetricCounter* metric_accumulator_resets_;
+    std::vector<PatchColor> metric_patch_colors_;   // Değişen patch sayımı için önceki renkler
+    void registerMetrics();
+
+    void switchTemplate(int index);
+    void resetHistories(int index);
+
+    cv::Mat extractBoard(const FrameView& frame, const std::vector<cv::Point2f>& corners, int warp_size);
+
+    cv::Mat applyPerspectiveTransform(const cv::Mat& frame,
+        const std::vector<cv::Point2f>& src_points, int warp_size);
+
+    void classifyPatches(const cv::Mat& warped_frame, int64_t timestamp_us,
+        std::vector<PatchInfo>& patch_infos);
+
+    void fillBoardState(const std::vector<PatchInfo>& patch_infos, BoardState& result);
+
+    cv::Point calculateContourCentroid(const std::vector<cv::Point>& contour);
+
+    // Rotasyon fonksiyonları
+    int detectRotation(const std::vector<std::vector<cv::Point2f>>& markers);
+    cv::Mat rotateImageInverse(const cv::Mat& image, int rotation);
+
+    // Otomatik template algılama
+    int detectTemplate(const cv::Mat& warped_normalized);
+    double calculateTemplateSimilarity(const cv::Mat& warped_lines, int template_index);
+
+public:
+    MosaicEngine(const std::vector<std::string>& template_paths,
+        const std::vector<std::string>& template_names,
+        int target_marker_id = 23);
+
+    MosaicEngine(const MosaicEngine&) = delete;
+    MosaicEngine& operator=(const MosaicEngine&) = delete;
+
+    // Sonuç result'a yazılır; patches'in kapasitesi korunduğu için her frame'de bellek
+    // ayrılmaz. Dönüş: tahta görüldü mü.
+    bool process(const FrameView& frame, int64_t timestamp_us, BoardState& result);
+    bool process(const cv::Mat& frame, PixelFormat format, int64_t timestamp_us, BoardState& result);
+    // Çağıranın tamponu üzerinde, kopyasız (stride: satır başına bayt, bkz. wrapFrame)
+    bool process(const void* data, int width, int height, size_t stride, PixelFormat format,
+        int64_t timestamp_us, BoardState& result);
+
+    // Son görülen tahtanın patch ayrıntıları (renk adı, çizilen renk, merkez)
+    const std::vector<PatchInfo>& lastPatches() const { return patch_infos_; }
+    // Son görülen tahtanın dijital çıktısı; en az bir tahta görüldükten sonra çağrılmalı.
+    // Dönen görüntü bir sonraki çağrıya kadar geçerlidir.
+    const cv::Mat& renderDigital();
+
+    void setKeepImages(bool keep);
+    const EngineImages& lastImages() const { return images_; }
+
+    // enabled = false: her patch'in tüm pikselleri sayılır
+    void setSamplingConfig(const SamplingConfig& config);
+    // MJPEG frame'lerde marker tespiti 1/scale decode üzerinde (1, 2, 4 veya 8)
+    void setMjpegDetectionScale(int scale);
+    // i. ID'li marker'larla çevrili tahta i. template'tir: template ilk frame'de değişir,
+    // görüntüden tanıma sadece seyrek kontrol olarak çalışır. Boş liste: görüntüden tanıma.
+    void setTemplateMarkerIds(const std::vector<int>& marker_ids);
+    // Lens bozulması düzeltmesi (bkz. CameraCalibration); geçersiz kalibrasyon: düzeltme yok
+    void setCalibration(const CameraCalibration& calibration);
+    // Bkz. AccumulatorConfig; kapalıyken her frame kendi görüntüsüyle sınıflandırılır
+    void setAccumulatorConfig(const AccumulatorConfig& config);
+    // Bkz. IdleConfig; kapatılırsa aktif moda dönülür
+    void setIdleConfig(const IdleConfig& config);
+    bool idle() const { return idle_; }
+    // Son frame'de marker araması yapıldı mı (boşta modunda atlanan frame'lerde false;
+    // bu frame'lerde lastImages() güncellenmez)
+    bool markerSearchRan() const { return marker_search_ran_; }
+    void printIdleStats() const;
+
+    // Aktif template'in renk / oran geçmişini sıfırlar
+    void resetHistories();
+    void printTemplates() const;
+    void printSamplingStats();
+
+    int currentTemplate() const { return current_template_index_; }
+    const std::string& templateName(int index) const { return template_names_[index]; }
+
+    // Toplu işleme: segmentler arası durum karşılaştırma ve aktarma
+    DetectorState getState() const;
+    void setState(const DetectorState& state);
+
+    MetricsRegistry& metrics() { return metrics_; }
+};
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include <string>
+#include <opencv2/core.hpp>
+
+struct PatchInfo {
+    int patch_id;
+    std::string color_name;
+    cv::Scalar color;           // Ekrana çizilen (stabil) renk (BGR)
+    float fill_ratio;
+    cv::Point centroid;         // Normalize (döndürülmemiş) koordinatlarda
+    int pixels_visited = 0;     // Sınıflandırmada incelenen piksel sayısı
+    int pixels_total = 0;       // Patch maskesindeki piksel sayısı
+};
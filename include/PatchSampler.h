@@ -0,0 +1,28 @@
+﻿#pragma once
+#include <vector>
+#include <opencv2/core.hpp>
+#include "TemplateProcessor.h"
+
+// Patch'lerin aşındırılmış maske piksellerini warp boyutu için bir kez hesaplar.
+// Pikseller bit-ters (van der Corput) sırada tutulur: listenin herhangi bir öneki
+// patch'in tamamına yayılır, böylece erken durdurulan örnekleme de temsilidir.
+class PatchSampler {
+private:
+    const TemplateProcessor* template_processor_;
+
+    cv::Size cached_size_;
+    std::vector<std::vector<cv::Point>> scaled_contours_;
+    std::vector<std::vector<cv::Point>> sample_points_;
+
+    void rebuild(cv::Size warped_size);
+
+public:
+    explicit PatchSampler(const TemplateProcessor& template_processor);
+
+    // Boyut değiştiyse maskeleri yeniden hesaplar
+    void prepare(cv::Size warped_size);
+
+    size_t patchCount() const { return sample_points_.size(); }
+    const std::vector<cv::Point>& scaledContour(size_t patch) const { return scaled_contours_[patch]; }
+    const std::vector<cv::Point>& samplePoints(size_t patch) const { return sample_points_[patch]; }
+};
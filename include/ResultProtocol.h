@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BoardState.h"
+
+// Tahta durumu için kompakt ikili mesaj formatı (little-endian).
+//
+// Başlık (38 byte):
+//   u32 magic | u8 version | u8 type | u16 rotation | u64 sequence | u64 frame_index |
+//   i64 timestamp_us | u16 template_index | u16 patch_count | u16 update_count
+// Ardından update_count adet kayıt (5 byte):
+//   u16 patch_id | u8 color | u16 fill_permille
+//
+// FULL_SNAPSHOT tüm patch'leri, DELTA sadece son mesajdan beri değişenleri taşır.
+// BOARD_LOST tahtanın görünmez olduğu ilk frame'de bir kez gider ve kayıt taşımaz
+// (template / rotasyon / patch_count son görülen tahtanındır). Tahta geri geldiğinde
+// gelen DELTA, kaybolmadan önceki son duruma göredir.
+
+const uint32_t RESULT_MESSAGE_MAGIC = 0x5246534D;  // "MSFR"
+const uint8_t RESULT_PROTOCOL_VERSION = 2;
+const size_t RESULT_HEADER_SIZE = 38;
+const size_t RESULT_UPDATE_SIZE = 5;
+
+enum class ResultMessageType : uint8_t {
+    FullSnapshot = 1,
+    Delta = 2,
+    BoardLost = 3
+};
+
+struct PatchUpdate {
+    uint16_t patch_id;
+    PatchColor color;
+    uint16_t fill_permille;     // Doluluk oranı * 1000
+};
+
+struct ResultMessage {
+    ResultMessageType type;
+    uint64_t sequence;
+    uint64_t frame_index;
+    int64_t timestamp_us;
+    uint16_t template_index;
+    uint16_t rotation;
+    uint16_t patch_count;
+    std::vector<PatchUpdate> updates;
+};
+
+uint16_t toFillPermille(float fill_ratio);
+
+size_t encodedResultSize(const ResultMessage& message);
+void encodeResultMessage(const ResultMessage& message, std::vector<uint8_t>& out);
+bool decodeResultMessage(const uint8_t* data, size_t size, ResultMessage& message);
+
+// Tüketici tarafı: mesajı tahta durumuna uygula. Delta, snapshot alınmadan
+// (veya farklı template için) gelirse false döner; bir sonraki snapshot beklenmeli.
+// BOARD_LOST son durumu korur, sadece board_visible'ı false yapar.
+bool applyResultMessage(const ResultMessage& message, std::vector<PatchUpdate>& board,
+    int& board_template, bool& board_visible);
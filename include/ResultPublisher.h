@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BoardState.h"
+#include "MessageRing.h"
+#include "ResultProtocol.h"
+
+struct PublisherConfig {
+    std::string shm_name = "mosaic_results";
+    size_t slot_count = 256;
+    size_t slot_size = 64 * 1024;           // ~13000 patch'lik tam snapshot sığar
+    std::string socket_path;                // Boş ise Unix socket kapalı
+    int full_snapshot_interval = 30;        // Her N mesajda bir tam snapshot
+};
+
+// Her frame'in tahta durumunu paylaşımlı bellek halkasına (ve opsiyonel olarak
+// Unix domain socket'e) yazar. Sadece değişen patch'ler gönderilir; template
+// değişiminde, yeni socket istemcisinde ve periyodik olarak tam snapshot gider.
+// Görünmez tahta durumu sadece görünürden geçişte BOARD_LOST olarak gönderilir.
+class ResultPublisher {
+private:
+    PublisherConfig config_;
+    std::unique_ptr<MessageRingWriter> ring_;
+
+    int server_socket_;
+    std::vector<int> client_sockets_;
+    bool client_joined_;
+
+    std::vector<PatchUpdate> last_published_;
+    int last_template_;
+    bool board_visible_;
+    uint64_t sequence_;
+    int messages_since_snapshot_;
+
+    ResultMessage message_;
+    std::vector<uint8_t> buffer_;
+
+    void openSocket();
+    void acceptClients();
+    void sendToClients(const std::vector<uint8_t>& data);
+    void closeSockets();
+
+public:
+    explicit ResultPublisher(const PublisherConfig& config);
+    ~ResultPublisher();
+
+    ResultPublisher(const ResultPublisher&) = delete;
+    ResultPublisher& operator=(const ResultPublisher&) = delete;
+
+    void publish(const BoardState& state);
+
+    // Tüketicilerin gördüğü durum: son gönderilen mesaj BOARD_LOST değil
+    bool boardVisible() const { return board_visible_; }
+
+    uint64_t publishedCount() const { return sequence_; }
+    size_t lastMessageSize() const { return buffer_.size(); }
+};
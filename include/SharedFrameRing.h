@@ -0,0 +1,112 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "FrameView.h"
+#include "SharedMemoryRegion.h"
+
+// Paylaşımlı bellekte tek üretici / tek okuyuculu frame halkası.
+//
+//   [ring başlığı + slot başlıkları]   4096 byte sınırına yuvarlanır
+//   [slot 0 piksel verisi]...          Her slot sayfa hizalı, cv::Mat doğrudan üstüne sarılır
+//
+// Üretici her zaman en yeni frame'i yayınlar, okuyucu hep en yenisini alır (yavaş okuyucu
+// frame atlar, üretici hiçbir zaman beklemez). Okuyucu elindeki frame'in slot'unu
+// reader_slot ile sahiplenir; üretici bu slot'u atlar, böylece frame bir sonraki
+// okumaya kadar kopyalanmadan kullanılabilir.
+struct SharedFrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t reserved;
+    uint64_t slot_capacity;                 // Slot başına en fazla piksel verisi (byte)
+    std::atomic<uint64_t> write_sequence;   // Yayınlanan frame sayısı
+    std::atomic<uint32_t> latest_slot;      // Son yayınlanan frame'in slot'u
+    std::atomic<uint32_t> reader_slot;      // Okuyucunun tuttuğu slot (NO_SLOT: yok)
+    std::atomic<uint32_t> closed;           // Üretici kapandı
+};
+
+struct SharedFrameSlot {
+    std::atomic<uint64_t> state;            // 2*seq+1: yazılıyor, 2*seq+2: hazır
+    int64_t timestamp_us;                   // Üreticinin steady_clock zamanı
+    uint32_t format;                        // PixelFormat
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t mat_type;
+    uint64_t step;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+    "Shared memory ring requires lock-free 32-bit atomics");
+
+class SharedFrameWriter {
+private:
+    std::unique_ptr<SharedMemoryRegion> region_;
+    SharedFrameRingHeader* header_;
+    SharedFrameSlot* slots_;
+    uint8_t* data_;
+    size_t data_stride_;
+    uint64_t next_sequence_;
+    uint32_t next_slot_;
+    uint32_t current_slot_;
+    uint64_t claimed_skips_;
+
+public:
+    SharedFrameWriter(const std::string& name, size_t slot_count, size_t slot_capacity);
+    ~SharedFrameWriter();
+
+    SharedFrameWriter(const SharedFrameWriter&) = delete;
+    SharedFrameWriter& operator=(const SharedFrameWriter&) = delete;
+
+    // Sıradaki boş slot'u ayırır ve üzerine sarılı Mat döner (üretici doğrudan buraya yazar).
+    // Frame slot'a sığmıyorsa boş Mat döner.
+    cv::Mat beginFrame(int rows, int cols, int mat_type);
+    void publish(PixelFormat format, int64_t timestamp_us);
+
+    // beginFrame + kopyalama + publish; sığmıyorsa false
+    bool write(const FrameView& frame, int64_t timestamp_us);
+
+    // Okuyuculara akışın bittiğini bildirir (yıkıcı da çağırır)
+    void close();
+
+    uint64_t written() const { return next_sequence_; }
+    // Okuyucu tuttuğu için atlanan slot sayısı
+    uint64_t claimedSkips() const { return claimed_skips_; }
+};
+
+enum class FrameReadResult {
+    Frame,
+    Empty,      // Son okumadan beri yeni frame yok
+    Closed      // Üretici kapandı, yeni frame gelmeyecek
+};
+
+class SharedFrameReader {
+private:
+    std::unique_ptr<SharedMemoryRegion> region_;
+    SharedFrameRingHeader* header_;
+    const SharedFrameSlot* slots_;
+    uint8_t* data_;
+    size_t data_stride_;
+    uint64_t next_sequence_;
+    uint64_t dropped_;
+
+public:
+    // Okuyucu bağlandığı andaki en yeni frame'den başlar
+    explicit SharedFrameReader(const std::string& name);
+    ~SharedFrameReader();
+
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+    // En yeni frame'i kopyalamadan sarar. Dönen görünüm bir sonraki acquire / release
+    // çağrısına kadar geçerlidir; önceki frame'in slot'u üreticiye bırakılır.
+    FrameReadResult acquire(FrameView& frame, int64_t& timestamp_us);
+    void release();
+
+    uint64_t nextSequence() const { return next_sequence_; }
+    // Okuyucu yetişemediği için atlanan frame sayısı
+    uint64_t dropped() const { return dropped_; }
+};
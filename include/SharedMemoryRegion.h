@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// İsimli paylaşımlı bellek bölgesi (POSIX shm_open / Windows file mapping).
+// Oluşturan taraf yok edildiğinde isim de sistemden kaldırılır.
+class SharedMemoryRegion {
+private:
+    std::string name_;
+    void* data_;
+    size_t size_;
+    bool owner_;
+#ifdef _WIN32
+    void* handle_;
+#endif
+
+    SharedMemoryRegion();
+
+public:
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    static std::unique_ptr<SharedMemoryRegion> create(const std::string& name, size_t size);
+    static std::unique_ptr<SharedMemoryRegion> open(const std::string& name);
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& name() const { return name_; }
+};
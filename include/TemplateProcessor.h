@@ -1,7 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
 
 class TemplateProcessor {
 private:
@@ -0,0 +1,446 @@
+﻿#include "BatchProcessor.h"
+#include "CaptureRecording.h"
+#include "FrameView.h"
+#include "MosaicEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <opencv2/videoio.hpp>
+
+namespace {
+
+// Segment başına en az bu kadar ısınma uzunluğu işlenmeli, yoksa bölmek kazandırmaz
+const size_t MIN_SEGMENT_WARMUP_RATIO = 4;
+
+// ===================== GİRİŞ =====================
+
+// Segment işçileri için rastgele erişimli frame kaynağı
+class BatchInput {
+public:
+    virtual ~BatchInput() = default;
+    virtual size_t frameCount() const = 0;
+    virtual bool seek(size_t index) = 0;
+    virtual bool read(FrameView& frame, int64_t& timestamp_us) = 0;
+    // Bundan sonra seek() sadece sıralı decode ile ilerler (konumlama güvenilmezse)
+    virtual void disableSeeking() {}
+};
+
+class RecordingInput : public BatchInput {
+private:
+    CaptureReplay replay_;
+    size_t next_ = 0;
+
+public:
+    explicit RecordingInput(const std::string& path) : replay_(path) {}
+
+    size_t frameCount() const override { return replay_.frameCount(); }
+
+    bool seek(size_t index) override {
+        next_ = index;
+        return index <= replay_.frameCount();
+    }
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override {
+        if (next_ >= replay_.frameCount()) return false;
+        return replay_.readFrame(next_++, frame, timestamp_us);
+    }
+};
+
+class VideoInput : public BatchInput {
+private:
+    std::string path_;
+    cv::VideoCapture capture_;
+    size_t frame_count_;
+    size_t next_ = 0;
+    bool seeking_ = true;
+    cv::Mat frame_;
+
+public:
+    explicit VideoInput(const std::string& path) : path_(path), capture_(path) {
+        if (!capture_.isOpened()) {
+            throw std::runtime_error("Failed to open video: " + path);
+        }
+        frame_count_ = static_cast<size_t>(std::max(0.0, capture_.get(cv::CAP_PROP_FRAME_COUNT)));
+    }
+
+    size_t frameCount() const override { return frame_count_; }
+
+    bool seek(size_t index) override {
+        if (index == next_) return true;
+
+        // Bazı codec'lerde konumlama anahtar frame'e düşer; bildirilen konum tutmuyorsa
+        // sıralı decode'a geç. Bildirilen konum doğru olsa bile frame kayabilir, bu yüzden
+        // process() segment sınırlarını ayrıca frame içeriğiyle doğrular.
+        if (seeking_) {
+            capture_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index));
+            if (static_cast<size_t>(capture_.get(cv::CAP_PROP_POS_FRAMES)) == index) {
+                next_ = index;
+                return true;
+            }
+            next_ = std::numeric_limits<size_t>::max();
+        }
+
+        if (index < next_) {
+            capture_.open(path_);
+            next_ = 0;
+        }
+        for (; next_ < index; ++next_) {
+            if (!capture_.grab()) return false;
+        }
+        return true;
+    }
+
+    void disableSeeking() override {
+        if (!seeking_) return;
+        seeking_ = false;
+        capture_.open(path_);
+        next_ = 0;
+    }
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override {
+        if (!capture_.read(frame_)) return false;
+        timestamp_us = static_cast<int64_t>(capture_.get(cv::CAP_PROP_POS_MSEC) * 1000.0);
+        frame = makeFrameView(frame_, PixelFormat::BGR);
+        next_++;
+        return true;
+    }
+};
+
+std::unique_ptr<BatchInput> openInput(const std::string& path) {
+    std::string extension = path.size() >= 5 ? path.substr(path.size() - 5) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".mrec") {
+        return std::make_unique<RecordingInput>(path);
+    }
+    return std::make_unique<VideoInput>(path);
+}
+
+// ===================== SEGMENTLER =====================
+
+struct SegmentOutput {
+    size_t from = 0;                        // İlk okunan frame (ısınma başı)
+    size_t begin = 0;
+    size_t end = 0;
+    size_t handoff = 0;                     // Sonraki segmentin from'u
+    uint64_t from_hash = 0;                 // from frame'inin içeriği
+    uint64_t begin_hash = 0;
+    uint64_t handoff_hash = 0;              // handoff frame'inin içeriği (bu segmentin decode'u)
+    bool has_handoff = false;
+    std::vector<BoardState> states;
+    std::vector<uint64_t> state_hashes;     // Her frame sonrası dedektör durumu
+    DetectorState entry_state;              // begin frame'inden hemen önce
+    DetectorState exit_state;
+    std::string error;
+};
+
+void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+// FNV-1a; frame başına tam durum saklamak yerine yakınsama testi için kullanılır
+uint64_t hashState(const DetectorState& state) {
+    uint64_t hash = 14695981039346656037ull;
+    int64_t values[] = { state.current_template_index, state.detected_template_index,
+        state.template_vote_us, state.current_rotation, state.rotation_vote_us,
+        state.last_observation_us };
+    hashBytes(hash, values, sizeof(values));
+
+    for (const auto& template_samples : state.color_samples) {
+        uint64_t patches = template_samples.size();
+        hashBytes(hash, &patches, sizeof(patches));
+        for (const auto& samples : template_samples) {
+            uint64_t count = samples.size();
+            hashBytes(hash, &count, sizeof(count));
+            for (const auto& sample : samples) {
+                double channels[4] = { sample.color[0], sample.color[1], sample.color[2], sample.color[3] };
+                hashBytes(hash, channels, sizeof(channels));
+                hashBytes(hash, &sample.timestamp_us, sizeof(sample.timestamp_us));
+            }
+        }
+    }
+    return hash;
+}
+
+// Frame baytlarının parmak izi; konumlamanın doğru frame'e düştüğünü doğrulamak için
+uint64_t hashFrame(const FrameView& frame) {
+    uint64_t hash = 14695981039346656037ull;
+    size_t row_bytes = frame.data.cols * frame.data.elemSize();
+    for (int y = 0; y < frame.data.rows; ++y) {
+        hashBytes(hash, frame.data.ptr(y), row_bytes);
+    }
+    return hash;
+}
+
+// [from, end) aralığını işler; begin'den itibaren sonuçları kaydeder
+void processRange(MosaicEngine& engine, BatchInput& input, SegmentOutput& segment) {
+    if (!input.seek(segment.from)) {
+        segment.error = "seek failed at frame " + std::to_string(segment.from);
+        return;
+    }
+
+    FrameView frame;
+    int64_t timestamp_us = 0;
+    BoardState state;
+    for (size_t i = segment.from; i < segment.end; ++i) {
+        if (i == segment.begin) segment.entry_state = engine.getState();
+        if (!input.read(frame, timestamp_us)) {
+            // Sadece son segment dosya sonuna kadar okur; diğerlerinde eksik frame birleştirmede
+            // boşluk bırakırdı
+            if (segment.end != std::numeric_limits<size_t>::max()) {
+                segment.error = "read failed at frame " + std::to_string(i);
+            }
+            break;
+        }
+
+        if (i == segment.from) segment.from_hash = hashFrame(frame);
+        if (i == segment.begin) segment.begin_hash = hashFrame(frame);
+        if (i == segment.handoff) {
+            segment.handoff_hash = hashFrame(frame);
+            segment.has_handoff = true;
+        }
+
+        engine.process(frame, timestamp_us, state);
+
+        if (i >= segment.begin) {
+            state.frame_index = i;
+            segment.states.push_back(state);
+            segment.state_hashes.push_back(hashState(engine.getState()));
+        }
+    }
+    segment.exit_state = engine.getState();
+
+    // Isınma yoksa sonraki segment tam bu segmentin bittiği frame'den başlar
+    if (segment.error.empty() && segment.handoff == segment.end && input.read(frame, timestamp_us)) {
+        segment.handoff_hash = hashFrame(frame);
+        segment.has_handoff = true;
+    }
+}
+
+// index'e konumlanıp o frame'i okur; içerik beklenen parmak iziyle uyuşmazsa sıralı
+// decode ile yeniden dener
+bool seekAndRead(BatchInput& input, size_t index, uint64_t expected_hash,
+    FrameView& frame, int64_t& timestamp_us) {
+
+    if (input.seek(index) && input.read(frame, timestamp_us) && hashFrame(frame) == expected_hash) {
+        return true;
+    }
+    input.disableSeeking();
+    return input.seek(index) && input.read(frame, timestamp_us) && hashFrame(frame) == expected_hash;
+}
+
+}
+
+BatchProcessor::BatchProcessor(const std::vector<std::string>& template_paths,
+    const std::vector<std::string>& template_names,
+    int target_marker_id,
+    const BatchConfig& config)
+    : template_paths_(template_paths), template_names_(template_names),
+    target_marker_id_(target_marker_id), config_(config) {
+}
+
+std::unique_ptr<MosaicEngine> BatchProcessor::makeEngine() const {
+    auto engine = std::make_unique<MosaicEngine>(template_paths_, template_names_, target_marker_id_);
+    engine->setSamplingConfig(config_.sampling);
+    engine->setTemplateMarkerIds(config_.template_marker_ids);
+    engine->setCalibration(config_.calibration);
+    engine->setMjpegDetectionScale(config_.mjpeg_detection_scale);
+    return engine;
+}
+
+BatchResult BatchProcessor::process(const std::string& input_path) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t frame_count = openInput(input_path)->frameCount();
+    size_t warmup = static_cast<size_t>(std::max(0, config_.warmup_frames));
+
+    size_t workers = config_.workers > 0 ? static_cast<size_t>(config_.workers)
+        : std::max(1u, std::thread::hardware_concurrency());
+    size_t min_length = std::max<size_t>(1, warmup * MIN_SEGMENT_WARMUP_RATIO);
+    size_t segment_count = std::max<size_t>(1, std::min(workers, frame_count / min_length));
+
+    std::vector<SegmentOutput> segments(segment_count);
+    for (size_t k = 0; k < segment_count; ++k) {
+        segments[k].begin = frame_count * k / segment_count;
+        segments[k].from = segments[k].begin > warmup ? segments[k].begin - warmup : 0;
+        // Son segment, frame sayısı yaklaşık olsa da (video) dosya sonuna kadar okur
+        segments[k].end = (k + 1 == segment_count) ? std::numeric_limits<size_t>::max()
+            : frame_count * (k + 1) / segment_count;
+    }
+    for (size_t k = 0; k + 1 < segment_count; ++k) {
+        segments[k].handoff = segments[k + 1].from;
+    }
+    segments.back().handoff = std::numeric_limits<size_t>::max();
+
+    // Segmentler zaten çekirdekleri doldurur; OpenCV'nin iç paralelliği sadece çakışır
+    int previous_threads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    auto runSegments = [&](size_t first, bool seeking) {
+        std::vector<std::thread> threads;
+        for (size_t k = first; k < segment_count; ++k) {
+            SegmentOutput& segment = segments[k];
+            threads.emplace_back([this, &segment, &input_path, seeking]() {
+                try {
+                    auto engine = makeEngine();
+                    auto input = openInput(input_path);
+                    if (!seeking) input->disableSeeking();
+                    processRange(*engine, *input, segment);
+                }
+                catch (const std::exception& e) {
+                    segment.error = e.what();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (const auto& segment : segments) {
+            if (!segment.error.empty()) {
+                cv::setNumThreads(previous_threads);
+                throw std::runtime_error("Batch segment failed: " + segment.error);
+            }
+        }
+    };
+
+    // Her segmentin ilk frame'i, önceki segmentin aynı indeksteki frame'iyle aynı olmalı.
+    // Segment 0 baştan okuduğu için referanstır; uymayan sınır konumlamanın frame-doğru
+    // olmadığını gösterir.
+    auto seekMismatch = [&segments, segment_count]() {
+        for (size_t k = 1; k < segment_count; ++k) {
+            if (!segments[k - 1].has_handoff || segments[k - 1].handoff_hash != segments[k].from_hash) {
+                return k;
+            }
+        }
+        return size_t(0);
+    };
+
+    BatchResult result;
+    result.segments = segment_count;
+
+    runSegments(0, true);
+    if (size_t k = seekMismatch()) {
+        // Bu girdide konumlamaya güvenilemez: segment 0 dışındakiler baştan sıralı decode ile
+        // ısınma başına ilerler (yine paralel; sadece decode tekrarlanır)
+        std::cerr << "Warning: seek is not frame-accurate for " << input_path << " (segment " << k
+            << "), re-decoding segments from the start" << std::endl;
+        for (size_t j = 1; j < segment_count; ++j) {
+            SegmentOutput& segment = segments[j];
+            segment.states.clear();
+            segment.state_hashes.clear();
+            segment.has_handoff = false;
+        }
+        runSegments(1, false);
+        result.unseekable_segments = segment_count - 1;
+        if ((k = seekMismatch())) {
+            cv::setNumThreads(previous_threads);
+            throw std::runtime_error("Batch segment " + std::to_string(k) +
+                " does not line up with the previous segment");
+        }
+    }
+
+    cv::setNumThreads(previous_threads);
+
+    // ---- Sıralı birleştirme ----
+
+    DetectorState carried = segments[0].exit_state;
+    result.states = segments[0].states;
+
+    std::unique_ptr<MosaicEngine> fixer;
+    std::unique_ptr<BatchInput> fix_input;
+
+    for (size_t k = 1; k < segment_count; ++k) {
+        const SegmentOutput& segment = segments[k];
+
+        if (segment.entry_state == carried) {
+            result.states.insert(result.states.end(), segment.states.begin(), segment.states.end());
+            carried = segment.exit_state;
+            continue;
+        }
+
+        // Isınma yetmedi: doğru durumdan sıralı devam et, işçinin durumuna yakınsayınca
+        // işçinin kalan sonuçları geçerlidir
+        if (!fixer) {
+            fixer = makeEngine();
+            fix_input = openInput(input_path);
+            if (result.unseekable_segments > 0) fix_input->disableSeeking();
+        }
+        fixer->setState(carried);
+
+        bool converged = false;
+        FrameView frame;
+        int64_t timestamp_us = 0;
+        BoardState state;
+        for (size_t j = 0; j < segment.states.size(); ++j) {
+            // İşçi bu frame'i okuyabildi; burada okunamaması girdinin tutarsız olduğu anlamına
+            // gelir ve kalan frame'ler sessizce düşmesin diye toplu işlem durdurulur
+            bool read = (j == 0)
+                ? seekAndRead(*fix_input, segment.begin, segment.begin_hash, frame, timestamp_us)
+                : fix_input->read(frame, timestamp_us);
+            if (!read) {
+                throw std::runtime_error("Batch fix-up could not read frame " +
+                    std::to_string(segment.begin + j) + " (segment " + std::to_string(k) +
+                    " has " + std::to_string(segment.states.size() - j) + " unmerged frames)");
+            }
+            fixer->process(frame, timestamp_us, state);
+            result.fixed_up_frames++;
+
+            state.frame_index = segment.begin + j;
+            result.states.push_back(state);
+
+            if (hashState(fixer->getState()) == segment.state_hashes[j]) {
+                result.states.insert(result.states.end(), segment.states.begin() + j + 1, segment.states.end());
+                carried = segment.exit_state;
+                converged = true;
+                break;
+            }
+        }
+        if (!converged) carried = fixer->getState();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+BatchResult BatchProcessor::processSequential(const std::string& input_path) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto engine = makeEngine();
+    auto input = openInput(input_path);
+
+    SegmentOutput segment;
+    segment.end = std::numeric_limits<size_t>::max();
+    segment.handoff = segment.end;
+    processRange(*engine, *input, segment);
+    if (!segment.error.empty()) {
+        throw std::runtime_error("Sequential run failed: " + segment.error);
+    }
+
+    BatchResult result;
+    result.segments = 1;
+    result.states = std::move(segment.states);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void writeBatchResults(const std::vector<BoardState>& states, std::ostream& out) {
+    out << "frame,timestamp_us,visible,template,rotation,patches\n";
+    out << std::setprecision(9);
+    for (const auto& state : states) {
+        out << state.frame_index << ',' << state.timestamp_us << ','
+            << (state.board_visible ? 1 : 0) << ',' << state.template_index << ','
+            << state.rotation << ',';
+        for (size_t i = 0; i < state.patches.size(); ++i) {
+            if (i > 0) out << ';';
+            out << patchColorName(state.patches[i].color) << ':' << state.patches[i].fill_ratio;
+        }
+        out << '\n';
+    }
+}
@@ -0,0 +1,147 @@
+﻿#include "BoardAccumulator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+// Hareket kontrolünde tahta bu kadar bölgeye ayrılır (kenar başına)
+const int MOTION_GRID = 16;
+
+// Hareket kontrolünde her eksende bakılan piksel aralığı
+const int MOTION_SAMPLE_STEP = 4;
+
+void BoardAccumulator::configure(const AccumulatorConfig& config) {
+    if (config.classify_interval < 1) {
+        throw std::runtime_error("Classification interval must be at least 1 frame!");
+    }
+    if (config.decay_shift < 1 || config.decay_shift > 7) {
+        throw std::runtime_error("Accumulator decay shift must be between 1 and 7!");
+    }
+    if (config.box_frames < 1 || config.box_frames > 64) {
+        throw std::runtime_error("Accumulator box length must be between 1 and 64 frames!");
+    }
+    config_ = config;
+    reset();
+}
+
+void BoardAccumulator::reset() {
+    sum_.release();
+    ring_.clear();
+    ring_next_ = 0;
+    frames_ = 0;
+}
+
+uint32_t BoardAccumulator::boxReciprocal() const {
+    // sum * reciprocal >> 16 = sum / frames (yuvarlanmış)
+    return (65536u + static_cast<uint32_t>(frames_) / 2) / static_cast<uint32_t>(frames_);
+}
+
+double BoardAccumulator::maxRegionDifference(const cv::Mat& board) const {
+    double sums[MOTION_GRID][MOTION_GRID] = {};
+    int counts[MOTION_GRID][MOTION_GRID] = {};
+    uint32_t reciprocal = config_.box ? boxReciprocal() : 0;
+
+    for (int y = 0; y < board.rows; y += MOTION_SAMPLE_STEP) {
+        const uint8_t* src = board.ptr<uint8_t>(y);
+        const uint16_t* acc = sum_.ptr<uint16_t>(y);
+        int region_y = y * MOTION_GRID / board.rows;
+
+        for (int x = 0; x < board.cols; x += MOTION_SAMPLE_STEP) {
+            int difference = 0;
+            for (int c = 0; c < 3; ++c) {
+                uint32_t value = acc[x * 3 + c];
+                int expected = config_.box ? static_cast<int>((value * reciprocal + 32768u) >> 16)
+                    : static_cast<int>((value + 128u) >> 8);
+                difference += std::abs(static_cast<int>(src[x * 3 + c]) - expected);
+            }
+            int region_x = x * MOTION_GRID / board.cols;
+            sums[region_y][region_x] += difference / 3.0;
+            counts[region_y][region_x]++;
+        }
+    }
+
+    double worst = 0.0;
+    for (int i = 0; i < MOTION_GRID; ++i) {
+        for (int j = 0; j < MOTION_GRID; ++j) {
+            if (counts[i][j] > 0) worst = std::max(worst, sums[i][j] / counts[i][j]);
+        }
+    }
+    return worst;
+}
+
+bool BoardAccumulator::add(const cv::Mat& board) {
+    CV_Assert(board.type() == CV_8UC3);
+
+    // Boyut değişimi, ilk frame veya büyük hareket (el, kayan tahta): eski frame'ler hayalet bırakmasın
+    bool restart = sum_.empty() || sum_.size() != board.size() ||
+        maxRegionDifference(board) > config_.motion_threshold;
+
+    if (restart) {
+        reset();
+        if (config_.box) {
+            board.convertTo(sum_, CV_16UC3);
+        }
+        else {
+            board.convertTo(sum_, CV_16UC3, 256.0);
+        }
+    }
+    else {
+        int n = board.cols * 3;
+        if (config_.box) {
+            // Toplama yeni frame eklenir, pencereden çıkan frame çıkarılır
+            const cv::Mat* oldest = frames_ >= config_.box_frames ? &ring_[ring_next_] : nullptr;
+            for (int y = 0; y < board.rows; ++y) {
+                const uint8_t* src = board.ptr<uint8_t>(y);
+                uint16_t* acc = sum_.ptr<uint16_t>(y);
+                if (oldest) {
+                    const uint8_t* old = oldest->ptr<uint8_t>(y);
+                    for (int i = 0; i < n; ++i) acc[i] = static_cast<uint16_t>(acc[i] + src[i] - old[i]);
+                }
+                else {
+                    for (int i = 0; i < n; ++i) acc[i] = static_cast<uint16_t>(acc[i] + src[i]);
+                }
+            }
+        }
+        else {
+            // acc += (frame * 256 - acc) / 2^shift
+            int shift = config_.decay_shift;
+            for (int y = 0; y < board.rows; ++y) {
+                const uint8_t* src = board.ptr<uint8_t>(y);
+                uint16_t* acc = sum_.ptr<uint16_t>(y);
+                for (int i = 0; i < n; ++i) {
+                    int value = acc[i];
+                    acc[i] = static_cast<uint16_t>(value + (((static_cast<int>(src[i]) << 8) - value) >> shift));
+                }
+            }
+        }
+    }
+
+    if (config_.box) {
+        if (ring_.size() < static_cast<size_t>(config_.box_frames)) {
+            ring_.push_back(board.clone());
+        }
+        else {
+            board.copyTo(ring_[ring_next_]);
+        }
+        ring_next_ = (ring_next_ + 1) % static_cast<size_t>(config_.box_frames);
+    }
+    frames_ = config_.box ? std::min(frames_ + 1, config_.box_frames) : frames_ + 1;
+    return restart;
+}
+
+const cv::Mat& BoardAccumulator::average() {
+    average_.create(sum_.size(), CV_8UC3);
+    uint32_t reciprocal = config_.box ? boxReciprocal() : 0;
+    int n = sum_.cols * 3;
+
+    for (int y = 0; y < sum_.rows; ++y) {
+        const uint16_t* acc = sum_.ptr<uint16_t>(y);
+        uint8_t* dst = average_.ptr<uint8_t>(y);
+        if (config_.box) {
+            for (int i = 0; i < n; ++i) dst[i] = static_cast<uint8_t>(std::min((acc[i] * reciprocal + 32768u) >> 16, 255u));
+        }
+        else {
+            for (int i = 0; i < n; ++i) dst[i] = static_cast<uint8_t>(std::min((acc[i] + 128u) >> 8, 255u));
+        }
+    }
+    return average_;
+}
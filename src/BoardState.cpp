@@ -0,0 +1,41 @@
+﻿#include "BoardState.h"
+
+PatchColor patchColorFromName(const std::string& color_name) {
+    if (color_name == "White") return PatchColor::White;
+    if (color_name == "Red") return PatchColor::Red;
+    if (color_name == "Orange") return PatchColor::Orange;
+    if (color_name == "Yellow") return PatchColor::Yellow;
+    if (color_name == "Green") return PatchColor::Green;
+    if (color_name == "Blue") return PatchColor::Blue;
+    if (color_name == "Purple") return PatchColor::Purple;
+    return PatchColor::Unknown;
+}
+
+bool sameBoardState(const BoardState& a, const BoardState& b) {
+    if (a.board_visible != b.board_visible) return false;
+    if (!a.board_visible) return true;
+    if (a.template_index != b.template_index || a.rotation != b.rotation ||
+        a.patches.size() != b.patches.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.patches.size(); ++i) {
+        if (a.patches[i].color != b.patches[i].color ||
+            a.patches[i].fill_ratio != b.patches[i].fill_ratio) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* patchColorName(PatchColor color) {
+    switch (color) {
+    case PatchColor::White: return "White";
+    case PatchColor::Red: return "Red";
+    case PatchColor::Orange: return "Orange";
+    case PatchColor::Yellow: return "Yellow";
+    case PatchColor::Green: return "Green";
+    case PatchColor::Blue: return "Blue";
+    case PatchColor::Purple: return "Purple";
+    default: return "Unknown";
+    }
+}
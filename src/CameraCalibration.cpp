@@ -0,0 +1,210 @@
+﻿#include "CameraCalibration.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+// Noktaların bozulmasının geri alınmasında iterasyon sınırı (geniş açılı lenslerde
+// varsayılan 5 iterasyon kenarlarda yetersiz kalır)
+const int UNDISTORT_ITERATIONS = 20;
+
+// Bozulma tablosunun aralığı (piksel). Bozulma yavaş değiştiği için doğrusal ara değer
+// hatası 0,05 pikselin altındadır; tablo tam çözünürlüğün dörtte biri kadardır.
+const int DISTORTION_GRID_STEP = 2;
+
+// Bozulmasız görüntü frame'in en fazla bu kadar katı dışarı taşar (balık gözünde sınırsız)
+const double DISTORTION_GRID_MAX_MARGIN = 1.0;
+
+// Birleşik tablo warp'ta bu aralıkla hesaplanıp doğrusal büyütülür. Homografi ve bozulma
+// birkaç piksel ölçeğinde neredeyse doğrusal olduğundan hata değişmez, maliyet 1/16'ya iner.
+const int WARP_MAP_STEP = 4;
+
+CameraCalibration::CameraCalibration(const cv::Mat& camera_matrix, const cv::Mat& dist_coeffs,
+    cv::Size image_size) : image_size_(image_size) {
+
+    if (camera_matrix.rows != 3 || camera_matrix.cols != 3) {
+        throw std::runtime_error("Camera matrix must be 3x3!");
+    }
+    cv::Mat matrix;
+    camera_matrix.convertTo(matrix, CV_64F);
+    camera_matrix_ = cv::Matx33d(matrix.ptr<double>());
+
+    cv::Mat coeffs;
+    dist_coeffs.reshape(1, 1).convertTo(coeffs, CV_64F);
+    size_t count = coeffs.total();
+    if (count != 4 && count != 5 && count != 8) {
+        throw std::runtime_error("Distortion coefficients must have 4, 5 or 8 elements!");
+    }
+    dist_coeffs_.assign(coeffs.ptr<double>(), coeffs.ptr<double>() + count);
+    dist_coeffs_.resize(8, 0.0);
+
+    if (image_size_.width <= 0 || image_size_.height <= 0) {
+        throw std::runtime_error("Calibration image size is missing!");
+    }
+}
+
+CameraCalibration CameraCalibration::load(const std::string& path) {
+    cv::FileStorage storage(path, cv::FileStorage::READ);
+    if (!storage.isOpened()) {
+        throw std::runtime_error("Could not open calibration file: " + path);
+    }
+
+    cv::Mat camera_matrix, dist_coeffs;
+    int width = 0, height = 0;
+    storage["camera_matrix"] >> camera_matrix;
+    storage["dist_coeffs"] >> dist_coeffs;
+    storage["image_width"] >> width;
+    storage["image_height"] >> height;
+    if (camera_matrix.empty() || dist_coeffs.empty()) {
+        throw std::runtime_error("Calibration file has no camera_matrix / dist_coeffs: " + path);
+    }
+    return CameraCalibration(camera_matrix, dist_coeffs, cv::Size(width, height));
+}
+
+void CameraCalibration::save(const std::string& path, double rms_error) const {
+    cv::FileStorage storage(path, cv::FileStorage::WRITE);
+    if (!storage.isOpened()) {
+        throw std::runtime_error("Could not write calibration file: " + path);
+    }
+    storage << "image_width" << image_size_.width;
+    storage << "image_height" << image_size_.height;
+    storage << "camera_matrix" << cv::Mat(camera_matrix_);
+    storage << "dist_coeffs" << cv::Mat(dist_coeffs_).reshape(1, 1);
+    if (rms_error >= 0.0) {
+        storage << "rms_error" << rms_error;
+    }
+}
+
+CameraCalibration CameraCalibration::scaledTo(cv::Size frame_size) const {
+    if (frame_size == image_size_) return *this;
+
+    CameraCalibration scaled = *this;
+    double sx = static_cast<double>(frame_size.width) / image_size_.width;
+    double sy = static_cast<double>(frame_size.height) / image_size_.height;
+    scaled.camera_matrix_(0, 0) *= sx;
+    scaled.camera_matrix_(0, 1) *= sx;
+    scaled.camera_matrix_(0, 2) *= sx;
+    scaled.camera_matrix_(1, 1) *= sy;
+    scaled.camera_matrix_(1, 2) *= sy;
+    scaled.image_size_ = frame_size;
+    return scaled;
+}
+
+void CameraCalibration::undistortPoints(std::vector<cv::Point2f>& points) const {
+    if (points.empty()) return;
+
+    cv::Mat matrix(camera_matrix_);
+    cv::undistortPoints(points, points, matrix, dist_coeffs_, cv::noArray(), matrix,
+        cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, UNDISTORT_ITERATIONS, 1e-4));
+}
+
+cv::Point2f CameraCalibration::distortPoint(double x, double y) const {
+    const cv::Matx33d& K = camera_matrix_;
+    const std::vector<double>& d = dist_coeffs_;
+
+    double ny = (y - K(1, 2)) / K(1, 1);
+    double nx = (x - K(0, 2) - K(0, 1) * ny) / K(0, 0);
+
+    double r2 = nx * nx + ny * ny;
+    double radial = (1.0 + r2 * (d[0] + r2 * (d[1] + r2 * d[4]))) /
+        (1.0 + r2 * (d[5] + r2 * (d[6] + r2 * d[7])));
+    double dx = nx * radial + 2.0 * d[2] * nx * ny + d[3] * (r2 + 2.0 * nx * nx);
+    double dy = ny * radial + d[2] * (r2 + 2.0 * ny * ny) + 2.0 * d[3] * nx * ny;
+
+    return cv::Point2f(static_cast<float>(K(0, 0) * dx + K(0, 1) * dy + K(0, 2)),
+        static_cast<float>(K(1, 1) * dy + K(1, 2)));
+}
+
+void CameraCalibration::buildDistortionGrid(int step, cv::Mat& grid, cv::Matx33d& to_grid) const {
+    // Frame kenarının bozulmasız karşılığı tablonun kapsamasını belirler
+    const int samples = 64;
+    std::vector<cv::Point2f> border;
+    for (int i = 0; i < samples; ++i) {
+        float tx = (image_size_.width - 1) * i / static_cast<float>(samples - 1);
+        float ty = (image_size_.height - 1) * i / static_cast<float>(samples - 1);
+        border.push_back(cv::Point2f(tx, 0.0f));
+        border.push_back(cv::Point2f(tx, static_cast<float>(image_size_.height - 1)));
+        border.push_back(cv::Point2f(0.0f, ty));
+        border.push_back(cv::Point2f(static_cast<float>(image_size_.width - 1), ty));
+    }
+    undistortPoints(border);
+
+    double max_margin_x = image_size_.width * DISTORTION_GRID_MAX_MARGIN;
+    double max_margin_y = image_size_.height * DISTORTION_GRID_MAX_MARGIN;
+    double left = 0.0, top = 0.0, right = image_size_.width, bottom = image_size_.height;
+    for (const auto& point : border) {
+        left = std::min(left, std::max<double>(point.x, -max_margin_x));
+        top = std::min(top, std::max<double>(point.y, -max_margin_y));
+        right = std::max(right, std::min<double>(point.x, image_size_.width + max_margin_x));
+        bottom = std::max(bottom, std::min<double>(point.y, image_size_.height + max_margin_y));
+    }
+    // Kenarda ara değer için iki hücre pay
+    left = std::floor(left) - 2 * step;
+    top = std::floor(top) - 2 * step;
+    cv::Size grid_size(static_cast<int>(std::ceil((right - left) / step)) + 3,
+        static_cast<int>(std::ceil((bottom - top) / step)) + 3);
+
+    to_grid = cv::Matx33d(1.0 / step, 0.0, -left / step,
+        0.0, 1.0 / step, -top / step,
+        0.0, 0.0, 1.0);
+
+    // Tablo pikseli, "kamera matrisi" to_grid * K olan bozulmasız görüntünün pikselidir
+    cv::Mat grid_matrix(to_grid * camera_matrix_);
+    cv::Mat unused;
+    cv::initUndistortRectifyMap(cv::Mat(camera_matrix_), dist_coeffs_, cv::noArray(), grid_matrix,
+        grid_size, CV_32FC2, grid, unused);
+}
+
+DistortionLookup::DistortionLookup(const CameraCalibration& calibration) {
+    calibration.buildDistortionGrid(DISTORTION_GRID_STEP, grid_, to_grid_);
+}
+
+cv::Rect DistortionLookup::composeWarp(const cv::Matx33d& warp_to_undistorted, cv::Size warp_size) {
+
+    // resize, büyütülmüş p pikselini kaynakta (p + 0,5) / s - 0,5'e oturtur. Kaba örnekler
+    // warp'ta u = s*i - (s/2 + 0,5) noktalarına konur ve sonuç s piksel kaydırılarak kesilir;
+    // böylece her warp pikseli iki kaba örneğin arasında kalır (kenarda dış değer kullanılmaz).
+    const int s = WARP_MAP_STEP;
+    cv::Size coarse_size((warp_size.width + s - 1) / s + 3, (warp_size.height + s - 1) / s + 3);
+    if (coarse_points_.size() != coarse_size) {
+        float first = -(s * 0.5f + 0.5f);
+        coarse_points_.create(coarse_size, CV_32FC2);
+        for (int j = 0; j < coarse_size.height; ++j) {
+            cv::Vec2f* row = coarse_points_.ptr<cv::Vec2f>(j);
+            for (int i = 0; i < coarse_size.width; ++i) {
+                row[i] = cv::Vec2f(first + s * i, first + s * j);
+            }
+        }
+    }
+
+    // Warp pikseli -> bozulmasız piksel -> tablo koordinatı tek homografide. Tablo frame'in
+    // tamamını kapsadığı için dışına düşen noktalar kenar değeriyle yine frame dışına gider.
+    cv::perspectiveTransform(coarse_points_, grid_points_, cv::Mat(to_grid_ * warp_to_undistorted));
+    cv::remap(grid_, coarse_map_, grid_points_, cv::noArray(), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    warp_size_ = warp_size;
+
+    // Doğrusal büyütme örneklerin dışına çıkmaz: seyrek örneklerin sınırı tam tablonun da sınırıdır
+    cv::Mat channels[2];
+    cv::split(coarse_map_, channels);
+    double min_x = 0.0, max_x = 0.0, min_y = 0.0, max_y = 0.0;
+    cv::minMaxLoc(channels[0], &min_x, &max_x);
+    cv::minMaxLoc(channels[1], &min_y, &max_y);
+
+    int left = static_cast<int>(std::floor(min_x));
+    int top = static_cast<int>(std::floor(min_y));
+    return cv::Rect(left, top, static_cast<int>(std::ceil(max_x)) - left + 1,
+        static_cast<int>(std::ceil(max_y)) - top + 1);
+}
+
+void DistortionLookup::buildWarpMap(cv::Point offset, cv::Mat& map1, cv::Mat& map2) {
+    const int s = WARP_MAP_STEP;
+    const cv::Mat* coarse = &coarse_map_;
+    if (offset != cv::Point(0, 0)) {
+        cv::subtract(coarse_map_, cv::Scalar(offset.x, offset.y), shifted_map_);
+        coarse = &shifted_map_;
+    }
+
+    cv::resize(*coarse, fine_map_, cv::Size(coarse->cols * s, coarse->rows * s), 0, 0, cv::INTER_LINEAR);
+    cv::convertMaps(fine_map_(cv::Rect(cv::Point(s, s), warp_size_)), cv::noArray(), map1, map2, CV_16SC2);
+}
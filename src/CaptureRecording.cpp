@@ -0,0 +1,366 @@
+﻿#include "CaptureRecording.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    const uint32_t FILE_MAGIC = 0x4345524D;     // "MREC"
+    const uint32_t FOOTER_MAGIC = 0x444E454D;   // "MEND"
+    const uint32_t FORMAT_VERSION = 1;
+
+    const uint32_t CHUNK_FRAME = 0x4D415246;    // "FRAM"
+    const uint32_t CHUNK_RESULT = 0x544C5352;   // "RSLT"
+    const uint32_t CHUNK_INDEX = 0x58444E49;    // "INDX"
+
+    const size_t FILE_HEADER_SIZE = 64;
+    const size_t CHUNK_HEADER_SIZE = 16;
+    const size_t FRAME_HEADER_SIZE = 48;
+    const size_t RESULT_HEADER_SIZE = 20;
+    const size_t RESULT_PATCH_SIZE = 8;
+    const size_t INDEX_ENTRY_SIZE = 24;
+    const size_t FOOTER_SIZE = 32;
+    const size_t CHUNK_ALIGNMENT = 64;
+
+    size_t alignUp(size_t value) {
+        return (value + CHUNK_ALIGNMENT - 1) & ~(CHUNK_ALIGNMENT - 1);
+    }
+
+    void putU16(std::vector<uint8_t>& out, uint16_t v) {
+        for (int i = 0; i < 2; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void putU32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void putU64(std::vector<uint8_t>& out, uint64_t v) {
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    uint16_t getU16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t getU32(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    uint64_t getU64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    uint32_t floatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float bitsToFloat(uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Chunk başlığı ve en az min_payload baytlık payload eşlenen dosyanın içinde mi
+    // (bozuk / kesik kayıtta indeksteki konum veya boyut dosyanın dışını gösterebilir)
+    bool chunkInFile(const uint8_t* base, size_t size, const uint8_t* chunk, size_t min_payload,
+        uint64_t& payload_size) {
+        size_t offset = static_cast<size_t>(chunk - base);
+        if (offset > size || size - offset < CHUNK_HEADER_SIZE) return false;
+        payload_size = getU64(chunk + 8);
+        return payload_size >= min_payload && payload_size <= size - offset - CHUNK_HEADER_SIZE;
+    }
+}
+
+// ===================== KAYIT =====================
+
+CaptureRecorder::CaptureRecorder(const std::string& path, bool lossless_compression)
+    : path_(path), lossless_compression_(lossless_compression), offset_(0) {
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to create recording: " + path);
+    }
+
+    std::vector<uint8_t> header;
+    putU32(header, FILE_MAGIC);
+    putU32(header, FORMAT_VERSION);
+    header.resize(FILE_HEADER_SIZE, 0);
+    file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    offset_ = header.size();
+
+    std::cout << "Recording to: " << path
+        << (lossless_compression ? " (PNG)" : " (raw)") << std::endl;
+}
+
+CaptureRecorder::~CaptureRecorder() {
+    try {
+        close();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Warning: could not finalize recording: " << e.what() << std::endl;
+    }
+}
+
+uint64_t CaptureRecorder::writeChunk(uint32_t type, uint32_t format, const std::vector<uint8_t>& header,
+    const uint8_t* data, size_t data_size) {
+
+    uint64_t chunk_offset = offset_;
+    size_t payload_size = header.size() + data_size;
+
+    std::vector<uint8_t> chunk_header;
+    putU32(chunk_header, type);
+    putU32(chunk_header, format);
+    putU64(chunk_header, payload_size);
+
+    file_.write(reinterpret_cast<const char*>(chunk_header.data()), chunk_header.size());
+    file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    if (data_size > 0) {
+        file_.write(reinterpret_cast<const char*>(data), data_size);
+    }
+
+    size_t written = CHUNK_HEADER_SIZE + payload_size;
+    size_t padded = alignUp(written);
+    static const char zeros[CHUNK_ALIGNMENT] = {};
+    file_.write(zeros, padded - written);
+
+    if (!file_) {
+        throw std::runtime_error("Write failed: " + path_);
+    }
+    offset_ += padded;
+    return chunk_offset;
+}
+
+void CaptureRecorder::writeFrame(const FrameView& frame, int64_t timestamp_us) {
+    if (!file_.is_open() || frame.data.empty()) return;
+
+    // PNG 2 kanallı (YUYV) görüntüleri desteklemez, onlar ham kalır; MJPEG zaten sıkıştırılmış
+    bool compress = lossless_compression_ && frame.data.depth() == CV_8U && frame.data.channels() != 2 &&
+        frame.format != PixelFormat::MJPEG;
+
+    cv::Mat continuous = frame.data.isContinuous() ? frame.data : frame.data.clone();
+    const uint8_t* data = continuous.data;
+    size_t data_size = continuous.total() * continuous.elemSize();
+
+    if (compress) {
+        std::vector<int> params = { cv::IMWRITE_PNG_COMPRESSION, 1 };
+        cv::imencode(".png", continuous, encode_buffer_, params);
+        data = encode_buffer_.data();
+        data_size = encode_buffer_.size();
+    }
+
+    std::vector<uint8_t> header;
+    putU64(header, static_cast<uint64_t>(timestamp_us));
+    putU64(header, index_.size());
+    putU32(header, static_cast<uint32_t>(continuous.cols));
+    putU32(header, static_cast<uint32_t>(continuous.rows));
+    putU32(header, static_cast<uint32_t>(continuous.type()));
+    putU32(header, static_cast<uint32_t>(compress ? FrameEncoding::Png : FrameEncoding::Raw));
+    putU64(header, data_size);
+    putU64(header, continuous.cols * continuous.elemSize());
+
+    IndexEntry entry;
+    entry.frame_offset = writeChunk(CHUNK_FRAME, static_cast<uint32_t>(frame.format),
+        header, data, data_size);
+    entry.result_offset = 0;
+    entry.timestamp_us = timestamp_us;
+    index_.push_back(entry);
+}
+
+void CaptureRecorder::writeResult(const BoardState& state) {
+    if (!file_.is_open() || index_.empty()) return;
+
+    std::vector<uint8_t> payload;
+    putU64(payload, state.frame_index);
+    payload.push_back(state.board_visible ? 1 : 0);
+    payload.push_back(0);
+    putU16(payload, static_cast<uint16_t>(state.template_index));
+    putU16(payload, static_cast<uint16_t>(state.rotation));
+    putU16(payload, 0);
+    putU32(payload, static_cast<uint32_t>(state.patches.size()));
+
+    // Fill oranı bit bit saklanır - replay karşılaştırması birebir olmalı
+    for (const auto& patch : state.patches) {
+        payload.push_back(static_cast<uint8_t>(patch.color));
+        payload.push_back(0);
+        putU16(payload, 0);
+        putU32(payload, floatBits(patch.fill_ratio));
+    }
+
+    index_.back().result_offset = writeChunk(CHUNK_RESULT, 0, payload, nullptr, 0);
+}
+
+void CaptureRecorder::close() {
+    if (!file_.is_open()) return;
+
+    std::vector<uint8_t> payload;
+    putU64(payload, index_.size());
+    for (const auto& entry : index_) {
+        putU64(payload, entry.frame_offset);
+        putU64(payload, entry.result_offset);
+        putU64(payload, static_cast<uint64_t>(entry.timestamp_us));
+    }
+    uint64_t index_offset = writeChunk(CHUNK_INDEX, 0, payload, nullptr, 0);
+
+    std::vector<uint8_t> footer;
+    putU32(footer, FOOTER_MAGIC);
+    putU32(footer, FORMAT_VERSION);
+    putU64(footer, index_offset);
+    putU64(footer, index_.size());
+    putU64(footer, 0);
+    file_.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    file_.close();
+
+    std::cout << "Recording closed: " << index_.size() << " frames -> " << path_ << std::endl;
+}
+
+// ===================== REPLAY =====================
+
+CaptureReplay::CaptureReplay(const std::string& path) {
+    file_ = std::make_unique<MappedFile>(path);
+
+    if (file_->size() < FILE_HEADER_SIZE || getU32(file_->data()) != FILE_MAGIC) {
+        throw std::runtime_error("Not a capture recording: " + path);
+    }
+    if (getU32(file_->data() + 4) != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported recording version: " + path);
+    }
+
+    if (!loadIndex()) {
+        std::cerr << "Warning: recording index missing, scanning chunks: " << path << std::endl;
+        scanChunks();
+    }
+}
+
+bool CaptureReplay::loadIndex() {
+    const uint8_t* base = file_->data();
+    size_t size = file_->size();
+    if (size < FILE_HEADER_SIZE + FOOTER_SIZE) return false;
+
+    const uint8_t* footer = base + size - FOOTER_SIZE;
+    if (getU32(footer) != FOOTER_MAGIC) return false;
+
+    uint64_t index_offset = getU64(footer + 8);
+    uint64_t frame_count = getU64(footer + 16);
+    if (index_offset + CHUNK_HEADER_SIZE + 8 + frame_count * INDEX_ENTRY_SIZE > size - FOOTER_SIZE ||
+        getU32(base + index_offset) != CHUNK_INDEX) {
+        return false;
+    }
+
+    const uint8_t* p = base + index_offset + CHUNK_HEADER_SIZE + 8;
+    entries_.clear();
+    for (uint64_t i = 0; i < frame_count; ++i, p += INDEX_ENTRY_SIZE) {
+        uint64_t frame_offset = getU64(p);
+        uint64_t result_offset = getU64(p + 8);
+        if (frame_offset >= size || result_offset >= size) return false;
+
+        Entry entry;
+        entry.frame_chunk = base + frame_offset;
+        entry.result_chunk = result_offset != 0 ? base + result_offset : nullptr;
+        entry.timestamp_us = static_cast<int64_t>(getU64(p + 16));
+        entries_.push_back(entry);
+    }
+    return true;
+}
+
+void CaptureReplay::scanChunks() {
+    const uint8_t* base = file_->data();
+    size_t size = file_->size();
+    size_t offset = FILE_HEADER_SIZE;
+
+    entries_.clear();
+    while (offset + CHUNK_HEADER_SIZE <= size) {
+        const uint8_t* chunk = base + offset;
+        uint32_t type = getU32(chunk);
+        uint64_t payload_size = getU64(chunk + 8);
+        if (offset + CHUNK_HEADER_SIZE + payload_size > size) break;   // Yarım kalmış chunk
+
+        if (type == CHUNK_FRAME && payload_size >= FRAME_HEADER_SIZE) {
+            Entry entry;
+            entry.frame_chunk = chunk;
+            entry.result_chunk = nullptr;
+            entry.timestamp_us = static_cast<int64_t>(getU64(chunk + CHUNK_HEADER_SIZE));
+            entries_.push_back(entry);
+        }
+        else if (type == CHUNK_RESULT && !entries_.empty()) {
+            entries_.back().result_chunk = chunk;
+        }
+        else if (type != CHUNK_INDEX) {
+            break;
+        }
+        offset += alignUp(CHUNK_HEADER_SIZE + payload_size);
+    }
+}
+
+bool CaptureReplay::readFrame(size_t index, FrameView& frame, int64_t& timestamp_us) const {
+    if (index >= entries_.size()) return false;
+
+    uint64_t payload_size = 0;
+    if (!chunkInFile(file_->data(), file_->size(), entries_[index].frame_chunk, FRAME_HEADER_SIZE,
+        payload_size)) {
+        return false;
+    }
+
+    PixelFormat format = static_cast<PixelFormat>(getU32(entries_[index].frame_chunk + 4));
+    const uint8_t* meta = entries_[index].frame_chunk + CHUNK_HEADER_SIZE;
+    timestamp_us = static_cast<int64_t>(getU64(meta));
+    int width = static_cast<int>(getU32(meta + 16));
+    int height = static_cast<int>(getU32(meta + 20));
+    int type = static_cast<int>(getU32(meta + 24));
+    FrameEncoding encoding = static_cast<FrameEncoding>(getU32(meta + 28));
+    uint64_t data_size = getU64(meta + 32);
+    uint64_t step = getU64(meta + 40);
+    if (data_size > payload_size - FRAME_HEADER_SIZE) return false;
+
+    uint8_t* data = const_cast<uint8_t*>(meta + FRAME_HEADER_SIZE);
+    cv::Mat image;
+    if (encoding == FrameEncoding::Raw) {
+        // Son satır dahil tüm pikseller frame verisinin içinde olmalı
+        if (width <= 0 || height <= 0 || type != CV_MAT_TYPE(type)) return false;
+        uint64_t row_bytes = static_cast<uint64_t>(width) * CV_ELEM_SIZE(type);
+        if (step < row_bytes || data_size < row_bytes ||
+            static_cast<uint64_t>(height - 1) > (data_size - row_bytes) / step) {
+            return false;
+        }
+        // Copy-on-write eşleme: işlem sırasında yazılsa bile dosya değişmez
+        image = cv::Mat(height, width, type, data, static_cast<size_t>(step));
+    }
+    else {
+        if (data_size == 0 || data_size > static_cast<uint64_t>(INT_MAX)) return false;
+        cv::Mat encoded(1, static_cast<int>(data_size), CV_8U, data);
+        image = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+    }
+    frame = makeFrameView(image, format);
+    return !image.empty();
+}
+
+bool CaptureReplay::readResult(size_t index, BoardState& state) const {
+    if (index >= entries_.size() || entries_[index].result_chunk == nullptr) return false;
+
+    const uint8_t* chunk = entries_[index].result_chunk;
+    uint64_t payload_size = 0;
+    if (!chunkInFile(file_->data(), file_->size(), chunk, RESULT_HEADER_SIZE, payload_size)) return false;
+    const uint8_t* p = chunk + CHUNK_HEADER_SIZE;
+
+    state.frame_index = getU64(p);
+    state.board_visible = p[8] != 0;
+    state.template_index = getU16(p + 10);
+    state.rotation = getU16(p + 12);
+    uint32_t patch_count = getU32(p + 16);
+    state.timestamp_us = entries_[index].timestamp_us;
+
+    if (payload_size < RESULT_HEADER_SIZE + patch_count * RESULT_PATCH_SIZE) return false;
+
+    state.patches.resize(patch_count);
+    p += RESULT_HEADER_SIZE;
+    for (auto& patch : state.patches) {
+        patch.color = static_cast<PatchColor>(p[0]);
+        patch.fill_ratio = bitsToFloat(getU32(p + 4));
+        p += RESULT_PATCH_SIZE;
+    }
+    return true;
+}
@@ -1,5 +1,28 @@
 ﻿#include "ColorDetector.h"
 #include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+struct Interval {
+    double low;
+    double high;
+};
+
+// Oran için Wilson aralığı; sonlu popülasyon düzeltmesi ile (n == population'da sıfır genişlik)
+Interval proportionInterval(int successes, int n, int population, double z) {
+    double p = static_cast<double>(successes) / n;
+    double z2n = z * z / n;
+    double center = (p + z2n / 2.0) / (1.0 + z2n);
+    double half = z / (1.0 + z2n) * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n));
+    if (population > 1) {
+        half *= std::sqrt(static_cast<double>(population - n) / (population - 1));
+    }
+    return { center - half, center + half };
+}
+
+}
 
 ColorDetector::ColorDetector(int min_val, int max_val, int min_sat)
     : min_value_(min_val), max_value_(max_val), min_saturation_(min_sat) {
@@ -57,6 +80,56 @@ bool ColorDetector::isPurple(int h, int r, int g, int b) const {
 
 // ===================== YARDIMCI FONKSİYONLAR =====================
 
+int ColorDetector::classifyPixel(const cv::Vec3b& hsv, const cv::Vec3b& bgr) const {
+    int h = hsv[0], s = hsv[1], v = hsv[2];
+    int b = bgr[0], g = bgr[1], r = bgr[2];
+
+    // Beyaz/gri tespiti
+    bool is_white_or_gray = (s < 35) || (v > 230 && s < 50);
+
+    // Çok koyu pikseller
+    bool is_too_dark = (v < 40);
+
+    if (is_white_or_gray || is_too_dark) {
+        return -1;
+    }
+
+    // Renk kategorilerini kontrol et
+    // ÖNCELİK SIRASI ÖNEMLİ: Mor, maviden önce kontrol edilmeli
+    if (isRed(h, r, g, b)) return RED;
+    if (isOrange(h, r, g, b)) return ORANGE;
+    if (isYellow(h, r, g)) return YELLOW;
+    if (isGreen(h, g, r, b)) return GREEN;
+    if (isPurple(h, r, g, b)) return PURPLE;  // Mor önce
+    if (isBlue(h, b, r, g)) return BLUE;      // Mavi sonra
+    return COLOR_CLASS_COUNT;                 // Renkli ama sınıfsız
+}
+
+cv::Scalar ColorDetector::pickDominant(const ColorCounts& counts, int non_white_pixels) const {
+    static const cv::Scalar class_colors[COLOR_CLASS_COUNT] = {
+        cv::Scalar(0, 0, 255),      // BGR: Kırmızı
+        cv::Scalar(0, 165, 255),    // BGR: Turuncu
+        cv::Scalar(0, 255, 255),    // BGR: Sarı
+        cv::Scalar(0, 255, 0),      // BGR: Yeşil
+        cv::Scalar(255, 0, 0),      // BGR: Mavi
+        cv::Scalar(255, 0, 255)     // BGR: Mor
+    };
+
+    // Dominant rengi bul
+    int threshold = std::max(3, non_white_pixels / 15);
+
+    int max_count = 0;
+    cv::Scalar dominant_color(255, 255, 255);
+
+    for (int i = 0; i < COLOR_CLASS_COUNT; ++i) {
+        if (counts[i] > threshold && counts[i] > max_count) {
+            max_count = counts[i];
+            dominant_color = class_colors[i];
+        }
+    }
+    return dominant_color;
+}
+
 std::string ColorDetector::getColorName(const cv::Scalar& color) const {
     int b = static_cast<int>(color[0]);
     int g = static_cast<int>(color[1]);
@@ -82,7 +155,7 @@ ColorDetectionResult ColorDetector::detectColorWithRatio(const cv::Mat& roi_bgr,
     ColorDetectionResult result;
     result.fill_ratio = 0.0f;
 
-    int red = 0, orange = 0, yellow = 0, green = 0, blue = 0, purple = 0;
+    ColorCounts counts = {};
     int total_valid_pixels = 0;
     int total_non_white_pixels = 0;
 
@@ -92,71 +165,114 @@ ColorDetectionResult ColorDetector::detectColorWithRatio(const cv::Mat& roi_bgr,
 
             total_valid_pixels++;
 
-            cv::Vec3b hsv = roi_hsv.at<cv::Vec3b>(y, x);
-            cv::Vec3b bgr = roi_bgr.at<cv::Vec3b>(y, x);
+            int color_class = classifyPixel(roi_hsv.at<cv::Vec3b>(y, x), roi_bgr.at<cv::Vec3b>(y, x));
+            if (color_class < 0) continue;
 
-            int h = hsv[0], s = hsv[1], v = hsv[2];
-            int b = bgr[0], g = bgr[1], r = bgr[2];
+            total_non_white_pixels++;
+            if (color_class < COLOR_CLASS_COUNT) counts[color_class]++;
+        }
+    }
 
-            // Beyaz/gri tespiti
-            bool is_white_or_gray = (s < 35) || (v > 230 && s < 50);
+    cv::Scalar dominant_color = pickDominant(counts, total_non_white_pixels);
 
-            // Çok koyu pikseller
-            bool is_too_dark = (v < 40);
+    result.color = dominant_color;
+    result.color_name = getColorName(dominant_color);
+    result.pixels_visited = total_valid_pixels;
+    result.pixels_total = total_valid_pixels;
 
-            if (is_white_or_gray || is_too_dark) {
-                continue;
-            }
+    if (total_valid_pixels > 0) {
+        result.fill_ratio = static_cast<float>(total_non_white_pixels) / static_cast<float>(total_valid_pixels);
+    }
 
-            total_non_white_pixels++;
+    return result;
+}
+
+ColorDetectionResult ColorDetector::detectColorSampled(const cv::Mat& frame_bgr,
+    const std::vector<cv::Point>& sample_points,
+    const SamplingConfig& config) const {
+
+    ColorDetectionResult result;
+    result.fill_ratio = 0.0f;
 
-            // Renk kategorilerini kontrol et
-            // ÖNCELİK SIRASI ÖNEMLİ: Mor, maviden önce kontrol edilmeli
-            if (isRed(h, r, g, b)) red++;
-            else if (isOrange(h, r, g, b)) orange++;
-            else if (isYellow(h, r, g)) yellow++;
-            else if (isGreen(h, g, r, b)) green++;
-            else if (isPurple(h, r, g, b)) purple++;  // Mor önce
-            else if (isBlue(h, b, r, g)) blue++;      // Mavi sonra
+    ColorCounts counts = {};
+    int total = static_cast<int>(sample_points.size());
+    int visited = 0;
+    int non_white = 0;
+    double z = config.confidence_z;
+
+    cv::Mat batch_bgr, batch_hsv;
+    int next_check = config.enabled ? std::min(std::max(config.min_samples, 1), total) : total;
+
+    while (visited < total) {
+        // HSV sadece bu turda gezilecek pikseller için (OpenCV dönüşümüyle birebir aynı)
+        int batch_end = std::min(next_check, total);
+        batch_bgr.create(1, batch_end - visited, CV_8UC3);
+        for (int i = visited; i < batch_end; ++i) {
+            batch_bgr.at<cv::Vec3b>(0, i - visited) = frame_bgr.at<cv::Vec3b>(sample_points[i]);
         }
-    }
+        cv::cvtColor(batch_bgr, batch_hsv, cv::COLOR_BGR2HSV);
 
-    // Dominant rengi bul
-    int threshold = std::max(3, total_non_white_pixels / 15);
+        for (int i = 0; i < batch_bgr.cols; ++i) {
+            int color_class = classifyPixel(batch_hsv.at<cv::Vec3b>(0, i), batch_bgr.at<cv::Vec3b>(0, i));
+            if (color_class < 0) continue;
 
-    int max_count = 0;
-    cv::Scalar dominant_color(255, 255, 255);
+            non_white++;
+            if (color_class < COLOR_CLASS_COUNT) counts[color_class]++;
+        }
+        visited = batch_end;
+        next_check = visited + std::max(config.batch_size, 1);
 
-    if (red > threshold && red > max_count) {
-        max_count = red;
-        dominant_color = cv::Scalar(0, 0, 255);      // BGR: Kırmızı
-    }
-    if (orange > threshold && orange > max_count) {
-        max_count = orange;
-        dominant_color = cv::Scalar(0, 165, 255);    // BGR: Turuncu
-    }
-    if (yellow > threshold && yellow > max_count) {
-        max_count = yellow;
-        dominant_color = cv::Scalar(0, 255, 255);    // BGR: Sarı
-    }
-    if (green > threshold && green > max_count) {
-        max_count = green;
-        dominant_color = cv::Scalar(0, 255, 0);      // BGR: Yeşil
-    }
-    if (blue > threshold && blue > max_count) {
-        max_count = blue;
-        dominant_color = cv::Scalar(255, 0, 0);      // BGR: Mavi
+        if (visited == total) break;
+
+        // --- Ardışık durma testi ---
+        Interval fill = proportionInterval(non_white, visited, total, z);
+        if ((fill.high - fill.low) / 2.0 > config.fill_error) continue;
+
+        // Doluluk eşiğin altında kalıyorsa renk kararı önemsiz (beyaz)
+        if (fill.high < config.min_fill_ratio) break;
+        if (config.min_fill_ratio > 0.0f && fill.low < config.min_fill_ratio) continue;
+        if (non_white == 0) break;
+
+        int leader = 0, runner_up = 0;
+        for (int count : counts) {
+            if (count > leader) {
+                runner_up = leader;
+                leader = count;
+            }
+            else if (count > runner_up) {
+                runner_up = count;
+            }
+        }
+
+        // Lider, non_white / 15 eşiğinin net olarak üstünde (veya tüm renkler net olarak altında) olmalı
+        int estimated_non_white = static_cast<int>(std::lround(static_cast<double>(non_white) * total / visited));
+        Interval share = proportionInterval(leader, non_white, estimated_non_white, z);
+        if (share.high < 1.0 / 15.0) break;
+        if (share.low <= 1.0 / 15.0) continue;
+
+        // Lider ile ikinci arasındaki fark istatistiksel olarak anlamlı olmalı
+        double remaining = std::sqrt(static_cast<double>(total - visited) / (total - 1));
+        if (leader - runner_up > z * std::sqrt(static_cast<double>(leader + runner_up)) * remaining) break;
     }
-    if (purple > threshold && purple > max_count) {
-        max_count = purple;
-        dominant_color = cv::Scalar(255, 0, 255);    // BGR: Mor
+
+    // Karar tüm patch'e ölçeklenmiş sayılarla verilir (tam gezmede ölçek 1)
+    ColorCounts estimated = counts;
+    int estimated_non_white = non_white;
+    if (visited > 0 && visited < total) {
+        double scale = static_cast<double>(total) / visited;
+        for (int& count : estimated) count = static_cast<int>(std::lround(count * scale));
+        estimated_non_white = static_cast<int>(std::lround(non_white * scale));
     }
 
+    cv::Scalar dominant_color = pickDominant(estimated, estimated_non_white);
+
     result.color = dominant_color;
     result.color_name = getColorName(dominant_color);
+    result.pixels_visited = visited;
+    result.pixels_total = total;
 
-    if (total_valid_pixels > 0) {
-        result.fill_ratio = static_cast<float>(total_non_white_pixels) / static_cast<float>(total_valid_pixels);
+    if (visited > 0) {
+        result.fill_ratio = static_cast<float>(non_white) / static_cast<float>(visited);
     }
 
     return result;
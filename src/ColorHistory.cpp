@@ -1,11 +1,31 @@
-#include "ColorHistory.h"
+﻿#include "ColorHistory.h"
+#include <algorithm>
+#include <cmath>
 
-ColorHistory::ColorHistory(size_t max_history) : max_history_(max_history) {}
+// Tek bir gözlemin temsil edebileceği en uzun süre: tahta uzun süre görünmezse
+// aradaki boşluk oylamada tek gözleme yazılmaz
+const int64_t MAX_SAMPLE_SPAN_US = 100000;
 
-void ColorHistory::addColor(const cv::Scalar& color) {
-    recent_colors_.push_back(color);
-    if (recent_colors_.size() > max_history_) {
-        recent_colors_.erase(recent_colors_.begin());
+// Pencerenin tamamını tutması garanti edilen en yüksek gözlem hızı. Gözlemler yaşa göre
+// düşülür; üst sınır sadece zaman damgası ilerlemeyen kaynakta belleği sınırlar.
+const int64_t MAX_SAMPLE_RATE_HZ = 1000;
+
+ColorHistory::ColorHistory(int window_ms) : window_us_(static_cast<int64_t>(window_ms) * 1000),
+    max_samples_(static_cast<size_t>(window_us_ * MAX_SAMPLE_RATE_HZ / 1000000 + 1)) {}
+
+void ColorHistory::addColor(const cv::Scalar& color, int64_t timestamp_us) {
+    // Zaman geriye giderse (kaynak değişimi, yeniden başlatma) eski gözlemler geçersiz
+    if (!recent_colors_.empty() && timestamp_us < recent_colors_.back().timestamp_us) {
+        recent_colors_.clear();
+    }
+    recent_colors_.push_back({ color, timestamp_us });
+
+    auto expired = std::find_if(recent_colors_.begin(), recent_colors_.end(),
+        [&](const ColorSample& sample) { return timestamp_us - sample.timestamp_us <= window_us_; });
+    recent_colors_.erase(recent_colors_.begin(), expired);
+
+    if (recent_colors_.size() > max_samples_) {
+        recent_colors_.erase(recent_colors_.begin(), recent_colors_.end() - max_samples_);
     }
 }
 
@@ -13,16 +33,32 @@ cv::Scalar ColorHistory::getStableColor() const {
     if (recent_colors_.empty()) {
         return cv::Scalar(255, 255, 255);
     }
+    if (recent_colors_.size() == 1) {
+        return recent_colors_[0].color;
+    }
+
+    // Ağırlık = gözlemin kapsadığı süre * exp(-yaş / (pencere / 2))
+    int64_t now = recent_colors_.back().timestamp_us;
+    double decay_us = std::max<double>(static_cast<double>(window_us_) / 2.0, 1.0);
 
-    std::map<int, int> color_votes;
-    for (const auto& color : recent_colors_) {
-        int color_id = static_cast<int>(color[0]) +
-            (static_cast<int>(color[1]) << 8) +
-            (static_cast<int>(color[2]) << 16);
-        color_votes[color_id]++;
+    std::map<int, double> color_votes;
+    for (size_t i = 0; i < recent_colors_.size(); ++i) {
+        const ColorSample& sample = recent_colors_[i];
+
+        // İlk gözlemin öncesi bilinmiyor: bir sonraki gözlemin aralığı kullanılır
+        size_t previous = i > 0 ? i - 1 : 0;
+        size_t current = i > 0 ? i : 1;
+        int64_t span = recent_colors_[current].timestamp_us - recent_colors_[previous].timestamp_us;
+        span = std::min(std::max<int64_t>(span, 1), MAX_SAMPLE_SPAN_US);
+
+        double age = static_cast<double>(now - sample.timestamp_us);
+        int color_id = static_cast<int>(sample.color[0]) +
+            (static_cast<int>(sample.color[1]) << 8) +
+            (static_cast<int>(sample.color[2]) << 16);
+        color_votes[color_id] += static_cast<double>(span) * std::exp(-age / decay_us);
     }
 
-    int max_votes = 0;
+    double max_votes = 0.0;
     int winning_color_id = 0;
     for (const auto& pair : color_votes) {
         if (pair.second > max_votes) {
@@ -40,4 +76,12 @@ cv::Scalar ColorHistory::getStableColor() const {
 
 void ColorHistory::clear() {
     recent_colors_.clear();
-}
\ No newline at end of file
+}
+
+const std::vector<ColorSample>& ColorHistory::getSamples() const {
+    return recent_colors_;
+}
+
+void ColorHistory::setSamples(const std::vector<ColorSample>& samples) {
+    recent_colors_ = samples;
+}
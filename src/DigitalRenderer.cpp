@@ -0,0 +1,299 @@
+﻿#include "DigitalRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+    const int SPRITE_FONT = cv::FONT_HERSHEY_SIMPLEX;
+    const double SPRITE_FONT_SCALE = 0.35;
+    const int SPRITE_THICKNESS = 1;
+    const int MAX_PERCENT = 100;
+
+    // Bu sayıdan fazla kirli bölge varsa tüm çıktıyı tek geçişte boyamak daha ucuz
+    const size_t MAX_DIRTY_REGIONS = 256;
+
+    const cv::Vec3b WHITE(255, 255, 255);
+    const cv::Vec3b BLACK(0, 0, 0);
+
+    // v * 0.5 (saturate_cast gibi yarımda çifte yuvarlanır). Derleme anında kurulur, böylece
+    // aynı anda çizen motorlar arasında paylaşılan değiştirilebilir durum yoktur.
+    struct HalfTable {
+        uchar values[256];
+        constexpr HalfTable() : values() {
+            for (int v = 0; v < 256; v++) {
+                int half = v / 2;
+                if (v % 2 == 1 && half % 2 == 1) half++;
+                values[v] = static_cast<uchar>(half);
+            }
+        }
+    };
+    constexpr HalfTable HALF_TABLE;
+
+    cv::Vec3b toVec3b(const cv::Scalar& color) {
+        return cv::Vec3b(cv::saturate_cast<uchar>(color[0]),
+            cv::saturate_cast<uchar>(color[1]),
+            cv::saturate_cast<uchar>(color[2]));
+    }
+
+    // Normalize koordinattaki noktayı döndürülmüş çıktıya taşı (rotateImage ile aynı yön)
+    cv::Point rotatePoint(const cv::Point& pt, cv::Size norm_size, int rotation) {
+        if (rotation == 90) {
+            return cv::Point(norm_size.height - 1 - pt.y, pt.x);
+        }
+        else if (rotation == 180) {
+            return cv::Point(norm_size.width - 1 - pt.x, norm_size.height - 1 - pt.y);
+        }
+        else if (rotation == 270) {
+            return cv::Point(pt.y, norm_size.width - 1 - pt.x);
+        }
+        return pt;
+    }
+}
+
+DigitalRenderer::DigitalRenderer(const TemplateProcessor& template_processor)
+    : template_processor_(&template_processor), cached_rotation_(0), valid_(false),
+    line_label_(0) {
+    buildSprites();
+}
+
+void DigitalRenderer::invalidate() {
+    valid_ = false;
+}
+
+// %0 - %100 yazılarını bir kez çiz; her frame'de sadece kopyalanırlar
+void DigitalRenderer::buildSprites() {
+    sprites_.clear();
+    for (int percent = 0; percent <= MAX_PERCENT; ++percent) {
+        std::string text = std::to_string(percent) + "%";
+
+        Sprite sprite;
+        int baseline = 0;
+        sprite.text_size = cv::getTextSize(text, SPRITE_FONT, SPRITE_FONT_SCALE,
+            SPRITE_THICKNESS, &baseline);
+
+        // Arka plan kutusu (+4) ve taban çizgisinin altına taşan kısım
+        sprite.alpha = cv::Mat::zeros(sprite.text_size.height + 4 + baseline,
+            sprite.text_size.width + 4, CV_8U);
+        cv::putText(sprite.alpha, text, cv::Point(2, sprite.text_size.height + 2),
+            SPRITE_FONT, SPRITE_FONT_SCALE, cv::Scalar(255), SPRITE_THICKNESS, cv::LINE_AA);
+
+        sprites_.push_back(sprite);
+    }
+}
+
+void DigitalRenderer::rebuildLabelMap(cv::Size size, int rotation) {
+    const auto& contours = template_processor_->getContours();
+    cv::Size template_size = template_processor_->getOutputSize();
+
+    float scale_x = static_cast<float>(size.width) / template_size.width;
+    float scale_y = static_cast<float>(size.height) / template_size.height;
+
+    // Konturları sırayla doldur - üst üste binenlerde sonraki patch kazanır
+    cv::Mat labels(size, CV_16U, cv::Scalar(0));
+    std::vector<std::vector<cv::Point>> scaled_contour(1);
+    for (size_t i = 0; i < contours.size(); ++i) {
+        scaled_contour[0].clear();
+        for (const auto& pt : contours[i]) {
+            scaled_contour[0].push_back(cv::Point(
+                static_cast<int>(pt.x * scale_x),
+                static_cast<int>(pt.y * scale_y)
+            ));
+        }
+        cv::drawContours(labels, scaled_contour, 0, cv::Scalar(static_cast<double>(i + 1)), cv::FILLED);
+    }
+
+    line_label_ = static_cast<ushort>(contours.size() + 1);
+
+    cv::Mat scaled_lines;
+    cv::resize(template_processor_->getTemplateLines(), scaled_lines, size, 0, 0, cv::INTER_NEAREST);
+    labels.setTo(cv::Scalar(line_label_), scaled_lines);
+
+    if (rotation == 90) {
+        cv::rotate(labels, labels_, cv::ROTATE_90_CLOCKWISE);
+    }
+    else if (rotation == 180) {
+        cv::rotate(labels, labels_, cv::ROTATE_180);
+    }
+    else if (rotation == 270) {
+        cv::rotate(labels, labels_, cv::ROTATE_90_COUNTERCLOCKWISE);
+    }
+    else {
+        labels_ = labels;
+    }
+
+    // Patch sınırlarını tek taramada bul
+    size_t num_patches = contours.size();
+    std::vector<int> min_x(num_patches, labels_.cols), min_y(num_patches, labels_.rows);
+    std::vector<int> max_x(num_patches, -1), max_y(num_patches, -1);
+    for (int y = 0; y < labels_.rows; y++) {
+        const ushort* row = labels_.ptr<ushort>(y);
+        for (int x = 0; x < labels_.cols; x++) {
+            int label = row[x];
+            if (label == 0 || label == line_label_) continue;
+            int i = label - 1;
+            min_x[i] = std::min(min_x[i], x);
+            max_x[i] = std::max(max_x[i], x);
+            min_y[i] = std::min(min_y[i], y);
+            max_y[i] = std::max(max_y[i], y);
+        }
+    }
+
+    patch_bounds_.assign(num_patches, cv::Rect());
+    for (size_t i = 0; i < num_patches; ++i) {
+        if (max_x[i] >= 0) {
+            patch_bounds_[i] = cv::Rect(min_x[i], min_y[i],
+                max_x[i] - min_x[i] + 1, max_y[i] - min_y[i] + 1);
+        }
+    }
+
+    palette_.assign(num_patches + 2, WHITE);
+    palette_[line_label_] = BLACK;
+    drawn_sprites_.assign(num_patches, -1);
+    sprite_origins_.assign(num_patches, cv::Point());
+
+    canvas_.create(labels_.size(), CV_8UC3);
+
+    cached_size_ = size;
+    cached_rotation_ = rotation;
+    valid_ = true;
+}
+
+cv::Rect DigitalRenderer::spriteRect(int patch_index) const {
+    const Sprite& sprite = sprites_[drawn_sprites_[patch_index]];
+    return cv::Rect(sprite_origins_[patch_index], sprite.alpha.size());
+}
+
+// Tek geçiş: her pikselin label'ını güncel renge eşle
+void DigitalRenderer::paintRegion(const cv::Rect& region) {
+    const cv::Vec3b* palette = palette_.data();
+    for (int y = region.y; y < region.y + region.height; y++) {
+        const ushort* labels = labels_.ptr<ushort>(y);
+        cv::Vec3b* out = canvas_.ptr<cv::Vec3b>(y);
+        for (int x = region.x; x < region.x + region.width; x++) {
+            out[x] = palette[labels[x]];
+        }
+    }
+}
+
+void DigitalRenderer::blitSprite(int patch_index, const cv::Rect& clip) {
+    const uchar* half = HALF_TABLE.values;
+
+    const Sprite& sprite = sprites_[drawn_sprites_[patch_index]];
+    cv::Point origin = sprite_origins_[patch_index];
+
+    cv::Rect area = spriteRect(patch_index) & clip & cv::Rect(0, 0, canvas_.cols, canvas_.rows);
+    cv::Rect background = cv::Rect(origin,
+        cv::Size(sprite.text_size.width + 4, sprite.text_size.height + 4)) & area;
+
+    // Yarı saydam siyah arka plan (addWeighted 0.5 / 0.5 ile aynı)
+    for (int y = background.y; y < background.y + background.height; y++) {
+        uchar* out = canvas_.ptr<uchar>(y);
+        for (int x = background.x * 3; x < (background.x + background.width) * 3; x++) {
+            out[x] = half[out[x]];
+        }
+    }
+
+    // Beyaz yazıyı kapsama oranıyla harmanla
+    for (int y = area.y; y < area.y + area.height; y++) {
+        const uchar* alpha = sprite.alpha.ptr<uchar>(y - origin.y);
+        cv::Vec3b* out = canvas_.ptr<cv::Vec3b>(y);
+        for (int x = area.x; x < area.x + area.width; x++) {
+            int a = alpha[x - origin.x];
+            if (a == 0) continue;
+            for (int c = 0; c < 3; c++) {
+                out[x][c] = static_cast<uchar>((out[x][c] * (255 - a) + 255 * a + 127) / 255);
+            }
+        }
+    }
+}
+
+void DigitalRenderer::redrawRegion(const cv::Rect& region) {
+    if (region.empty()) return;
+
+    paintRegion(region);
+
+    // Patch sırasıyla çiz - üst üste binen yazılar eskisi gibi birikir
+    for (size_t i = 0; i < drawn_sprites_.size(); ++i) {
+        if (drawn_sprites_[i] < 0) continue;
+        if ((spriteRect(static_cast<int>(i)) & region).empty()) continue;
+        blitSprite(static_cast<int>(i), region);
+    }
+}
+
+const cv::Mat& DigitalRenderer::render(cv::Size size, int rotation,
+    const std::vector<PatchInfo>& patch_infos) {
+
+    bool full_redraw = false;
+    if (!valid_ || size != cached_size_ || rotation != cached_rotation_) {
+        rebuildLabelMap(size, rotation);
+        full_redraw = true;
+    }
+
+    cv::Rect canvas_rect(0, 0, canvas_.cols, canvas_.rows);
+    std::vector<cv::Rect> dirty;
+    long long dirty_area = 0;
+
+    size_t count = std::min(patch_bounds_.size(), patch_infos.size());
+    for (size_t i = 0; i < count; ++i) {
+        const PatchInfo& info = patch_infos[i];
+
+        cv::Vec3b color = toVec3b(info.color);
+        if (palette_[i + 1] != color) {
+            palette_[i + 1] = color;
+            dirty.push_back(patch_bounds_[i]);
+            dirty_area += patch_bounds_[i].area();
+        }
+
+        // Beyaz patch'ler (eşik altı dahil) yazı almaz
+        int sprite_index = -1;
+        cv::Point origin;
+        if (info.color_name != "White") {
+            int percent = static_cast<int>(std::nearbyint(info.fill_ratio * 100));
+            percent = std::max(0, std::min(MAX_PERCENT, percent));
+            const Sprite& sprite = sprites_[percent];
+
+            cv::Point centroid = rotatePoint(info.centroid, size, rotation);
+            cv::Point text_pos(
+                centroid.x - sprite.text_size.width / 2,
+                centroid.y + sprite.text_size.height / 2
+            );
+            cv::Rect bg_rect(
+                text_pos.x - 2,
+                text_pos.y - sprite.text_size.height - 2,
+                sprite.text_size.width + 4,
+                sprite.text_size.height + 4
+            );
+
+            if (bg_rect.x >= 0 && bg_rect.y >= 0 &&
+                bg_rect.x + bg_rect.width < canvas_.cols &&
+                bg_rect.y + bg_rect.height < canvas_.rows) {
+                sprite_index = percent;
+                origin = bg_rect.tl();
+            }
+        }
+
+        if (sprite_index != drawn_sprites_[i] ||
+            (sprite_index >= 0 && origin != sprite_origins_[i])) {
+            if (drawn_sprites_[i] >= 0) {
+                dirty.push_back(spriteRect(static_cast<int>(i)));
+            }
+            drawn_sprites_[i] = sprite_index;
+            sprite_origins_[i] = origin;
+            if (sprite_index >= 0) {
+                dirty.push_back(spriteRect(static_cast<int>(i)));
+            }
+        }
+    }
+
+    if (full_redraw || dirty.size() > MAX_DIRTY_REGIONS ||
+        dirty_area > static_cast<long long>(canvas_rect.area()) / 2) {
+        redrawRegion(canvas_rect);
+    }
+    else {
+        for (const auto& region : dirty) {
+            redrawRegion(region & canvas_rect);
+        }
+    }
+
+    return canvas_;
+}
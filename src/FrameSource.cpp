@@ -0,0 +1,111 @@
+﻿#include "FrameSource.h"
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+// Yeni frame beklerken önce kısa süre dönülür, sonra uyunur
+const int SHARED_FRAME_SPIN_COUNT = 200;
+const int SHARED_FRAME_SLEEP_US = 100;
+
+int64_t steadyTimestampUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ===================== VIDEOCAPTURE =====================
+
+VideoCaptureSource::VideoCaptureSource(int camera_index, const CaptureConfig& config)
+    : capture_(camera_index), is_camera_(true) {
+    if (!capture_.isOpened()) {
+        throw std::runtime_error("Failed to open camera!");
+    }
+    configure(config);
+}
+
+VideoCaptureSource::VideoCaptureSource(const std::string& video_path)
+    : capture_(video_path), is_camera_(false) {
+    if (!capture_.isOpened()) {
+        throw std::runtime_error("Failed to open video: " + video_path);
+    }
+}
+
+void VideoCaptureSource::configure(const CaptureConfig& config) {
+    config_ = config;
+    if (!is_camera_) return;
+
+    if (config.format == CaptureFormat::MJPEG) {
+        capture_.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    }
+    capture_.set(cv::CAP_PROP_FRAME_WIDTH, config.width);
+    capture_.set(cv::CAP_PROP_FRAME_HEIGHT, config.height);
+
+    // BGR dışındaki yollarda kamera tamponu dönüştürülmeden verilir
+    capture_.set(cv::CAP_PROP_CONVERT_RGB, config.format == CaptureFormat::BGR ? 1 : 0);
+}
+
+bool VideoCaptureSource::read(FrameView& frame, int64_t& timestamp_us) {
+    capture_ >> raw_;
+    if (raw_.empty()) return false;
+
+    timestamp_us = steadyTimestampUs();
+    frame = is_camera_ && config_.format != CaptureFormat::BGR
+        ? wrapNativeFrame(raw_, static_cast<int>(capture_.get(cv::CAP_PROP_FOURCC)),
+            static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+            static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT)))
+        : makeFrameView(raw_, PixelFormat::BGR);
+    return true;
+}
+
+// ===================== KAYIT =====================
+
+ReplaySource::ReplaySource(const std::string& path, bool realtime)
+    : replay_(path), realtime_(realtime) {
+}
+
+bool ReplaySource::read(FrameView& frame, int64_t& timestamp_us) {
+    while (next_ < replay_.frameCount()) {
+        size_t index = next_++;
+        if (!replay_.readFrame(index, frame, timestamp_us)) {
+            std::cerr << "Warning: could not read frame " << index << std::endl;
+            continue;
+        }
+
+        if (realtime_) {
+            if (index == 0) wall_start_ = std::chrono::steady_clock::now();
+            std::this_thread::sleep_until(wall_start_ +
+                std::chrono::microseconds(timestamp_us - replay_.timestamp(0)));
+        }
+        last_index_ = index;
+        return true;
+    }
+    return false;
+}
+
+// ===================== PAYLAŞIMLI BELLEK =====================
+
+SharedMemoryFrameSource::SharedMemoryFrameSource(const std::string& name, int timeout_ms)
+    : reader_(name), timeout_ms_(timeout_ms) {
+}
+
+bool SharedMemoryFrameSource::read(FrameView& frame, int64_t& timestamp_us) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+
+    for (int attempt = 0;; ++attempt) {
+        FrameReadResult result = reader_.acquire(frame, timestamp_us);
+        if (result == FrameReadResult::Frame) {
+            frames_++;
+            return true;
+        }
+        if (result == FrameReadResult::Closed) return false;
+
+        if (attempt < SHARED_FRAME_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "No frame from producer for " << timeout_ms_ << " ms" << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(SHARED_FRAME_SLEEP_US));
+    }
+}
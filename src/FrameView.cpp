@@ -0,0 +1,178 @@
+﻿#include "FrameView.h"
+#include "JpegDecode.h"
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+    int makeFourcc(char a, char b, char c, char d) {
+        return (a & 255) | ((b & 255) << 8) | ((c & 255) << 16) | ((d & 255) << 24);
+    }
+
+    // NV12 UV düzlemi: (H/2)x(W/2) CV_8UC2, kopyasız
+    cv::Mat chromaPlaneNV12(const FrameView& frame) {
+        return cv::Mat(frame.height / 2, frame.width / 2, CV_8UC2,
+            const_cast<uchar*>(frame.data.ptr(frame.height)), frame.data.step);
+    }
+}
+
+FrameView makeFrameView(const cv::Mat& data, PixelFormat format) {
+    FrameView frame;
+    frame.format = format;
+    frame.data = data;
+    frame.width = data.cols;
+    frame.height = format == PixelFormat::NV12 ? data.rows * 2 / 3 : data.rows;
+
+    cv::Size jpeg_size;
+    if (format == PixelFormat::MJPEG && readJpegSize(data, jpeg_size)) {
+        frame.width = jpeg_size.width;
+        frame.height = jpeg_size.height;
+    }
+    return frame;
+}
+
+FrameView wrapFrame(const void* data, int width, int height, size_t stride, PixelFormat format) {
+    int type = CV_8UC1;
+    int rows = height;
+    switch (format) {
+    case PixelFormat::BGR: type = CV_8UC3; break;
+    case PixelFormat::YUYV: type = CV_8UC2; break;
+    case PixelFormat::NV12: rows = height * 3 / 2; break;
+    case PixelFormat::Gray: break;
+    default:
+        throw std::runtime_error("Use wrapJpegFrame for compressed frames");
+    }
+    if (data == nullptr || width <= 0 || height <= 0) {
+        throw std::runtime_error("Invalid frame buffer");
+    }
+
+    // cv::Mat sadece başlık: veri çağıranın tamponunda kalır
+    size_t step = stride == 0 ? static_cast<size_t>(cv::Mat::AUTO_STEP) : stride;
+    cv::Mat mat(rows, width, type, const_cast<void*>(data), step);
+    return makeFrameView(mat, format);
+}
+
+FrameView wrapJpegFrame(const void* data, size_t size) {
+    if (data == nullptr || size == 0) {
+        throw std::runtime_error("Invalid frame buffer");
+    }
+    cv::Mat mat(1, static_cast<int>(size), CV_8UC1, const_cast<void*>(data));
+    return makeFrameView(mat, PixelFormat::MJPEG);
+}
+
+FrameView wrapNativeFrame(const cv::Mat& raw, int fourcc, int width, int height) {
+    if (raw.channels() == 3) {
+        return makeFrameView(raw, PixelFormat::BGR);
+    }
+
+    // Bazı backend'ler tamponu 1xN olarak döner, gerçek boyutlara göre yeniden yorumla
+    size_t bytes = raw.total() * raw.elemSize();
+
+    if (fourcc == makeFourcc('M', 'J', 'P', 'G') && raw.type() == CV_8UC1 && (raw.rows == 1 || raw.cols == 1)) {
+        return makeFrameView(raw.reshape(1, 1), PixelFormat::MJPEG);
+    }
+    if (fourcc == makeFourcc('Y', 'U', 'Y', 'V') || fourcc == makeFourcc('Y', 'U', 'Y', '2')) {
+        if (raw.type() == CV_8UC2 && raw.rows == height) {
+            return makeFrameView(raw, PixelFormat::YUYV);
+        }
+        if (raw.isContinuous() && bytes == static_cast<size_t>(width) * height * 2) {
+            return makeFrameView(cv::Mat(height, width, CV_8UC2, raw.data), PixelFormat::YUYV);
+        }
+    }
+    else if (fourcc == makeFourcc('N', 'V', '1', '2')) {
+        if (raw.isContinuous() && bytes == static_cast<size_t>(width) * height * 3 / 2) {
+            return makeFrameView(cv::Mat(height * 3 / 2, width, CV_8UC1, raw.data), PixelFormat::NV12);
+        }
+    }
+    else if (raw.type() == CV_8UC1 && raw.rows == height && raw.cols == width) {
+        return makeFrameView(raw, PixelFormat::Gray);
+    }
+
+    throw std::runtime_error("Unsupported native capture format");
+}
+
+cv::Mat lumaPlane(const FrameView& frame) {
+    switch (frame.format) {
+    case PixelFormat::NV12:
+        return frame.data.rowRange(0, frame.height);
+    case PixelFormat::YUYV: {
+        // Y baytları iç içe - tek kanal ayıklama, renk dönüşümü değil
+        cv::Mat luma;
+        cv::extractChannel(frame.data, luma, 0);
+        return luma;
+    }
+    case PixelFormat::MJPEG:
+        return decodeJpegReducedGray(frame.data, 1);
+    default:
+        return frame.data;
+    }
+}
+
+void convertRegionToBGR(const FrameView& frame, const cv::Rect& region,
+    cv::Mat& bgr, cv::Point& offset) {
+
+    if (frame.format == PixelFormat::MJPEG) {
+        decodeJpegRegion(frame.data, region, bgr, offset);
+        return;
+    }
+
+    cv::Rect bounds(0, 0, frame.width, frame.height);
+    cv::Rect roi = region & bounds;
+
+    if (frame.format == PixelFormat::YUYV || frame.format == PixelFormat::NV12) {
+        // Kroma alt örneklemesi: bölge çift koordinat ve boyutlara hizalanmalı
+        int x0 = roi.x & ~1;
+        int y0 = roi.y & ~1;
+        int x1 = std::min((roi.x + roi.width + 1) & ~1, frame.width & ~1);
+        int y1 = std::min((roi.y + roi.height + 1) & ~1, frame.height & ~1);
+        roi = cv::Rect(x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0));
+    }
+
+    offset = roi.tl();
+    if (roi.empty()) {
+        bgr.release();
+        return;
+    }
+
+    switch (frame.format) {
+    case PixelFormat::BGR:
+        bgr = frame.data(roi);
+        break;
+    case PixelFormat::Gray:
+        cv::cvtColor(frame.data(roi), bgr, cv::COLOR_GRAY2BGR);
+        break;
+    case PixelFormat::YUYV:
+        cv::cvtColor(frame.data(roi), bgr, cv::COLOR_YUV2BGR_YUYV);
+        break;
+    case PixelFormat::NV12: {
+        cv::Mat luma = frame.data(roi);
+        cv::Mat chroma = chromaPlaneNV12(frame)(
+            cv::Rect(roi.x / 2, roi.y / 2, roi.width / 2, roi.height / 2));
+        cv::cvtColorTwoPlane(luma, chroma, bgr, cv::COLOR_YUV2BGR_NV12);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void convertToBGR(const FrameView& frame, cv::Mat& bgr) {
+    switch (frame.format) {
+    case PixelFormat::BGR:
+        bgr = frame.data;
+        break;
+    case PixelFormat::Gray:
+        cv::cvtColor(frame.data, bgr, cv::COLOR_GRAY2BGR);
+        break;
+    case PixelFormat::YUYV:
+        cv::cvtColor(frame.data, bgr, cv::COLOR_YUV2BGR_YUYV);
+        break;
+    case PixelFormat::NV12:
+        cv::cvtColor(frame.data, bgr, cv::COLOR_YUV2BGR_NV12);
+        break;
+    case PixelFormat::MJPEG:
+        bgr = cv::imdecode(frame.data, cv::IMREAD_COLOR);
+        break;
+    }
+}
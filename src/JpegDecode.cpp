@@ -0,0 +1,142 @@
+﻿#include "JpegDecode.h"
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#ifdef MOSAIC_WITH_LIBJPEG_TURBO
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace {
+
+#ifdef MOSAIC_WITH_LIBJPEG_TURBO
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info) {
+    std::longjmp(reinterpret_cast<JpegErrorManager*>(info->err)->jump, 1);
+}
+
+// region dışındaki satırları atlayarak (jpeg_skip_scanlines) ve sütunları kırparak decode
+bool decodeRegionTurbo(const cv::Mat& jpeg, const cv::Rect& region, cv::Mat& bgr, cv::Point& offset) {
+    jpeg_decompress_struct info;
+    JpegErrorManager error;
+    info.err = jpeg_std_error(&error.base);
+    error.base.error_exit = jpegErrorExit;
+
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, jpeg.ptr<unsigned char>(), static_cast<unsigned long>(jpeg.total()));
+    jpeg_read_header(&info, TRUE);
+    info.out_color_space = JCS_EXT_BGR;
+    jpeg_start_decompress(&info);
+
+    cv::Rect bounds(0, 0, static_cast<int>(info.output_width), static_cast<int>(info.output_height));
+    cv::Rect roi = region & bounds;
+    if (roi.empty()) {
+        jpeg_abort_decompress(&info);
+        jpeg_destroy_decompress(&info);
+        bgr.release();
+        offset = cv::Point(0, 0);
+        return true;
+    }
+
+    // Sütunlar iMCU sınırına hizalanır, x_offset / width buna göre güncellenir.
+    // Kırpmanın kenar sütunu upsampling'de kenar tekrarıyla hesaplanır (tam decode'dan
+    // farklı); bölgenin her iki yanına bir sütun eklenerek bu sütun bölge dışında tutulur.
+    JDIMENSION x_end = std::min(static_cast<JDIMENSION>(roi.x + roi.width + 1), info.output_width);
+    JDIMENSION x_offset = static_cast<JDIMENSION>(roi.x > 0 ? roi.x - 1 : 0);
+    JDIMENSION width = x_end - x_offset;
+    jpeg_crop_scanline(&info, &x_offset, &width);
+
+    if (roi.y > 0) {
+        jpeg_skip_scanlines(&info, static_cast<JDIMENSION>(roi.y));
+    }
+
+    bgr.create(roi.height, static_cast<int>(width), CV_8UC3);
+    while (info.output_scanline < static_cast<JDIMENSION>(roi.y + roi.height)) {
+        JSAMPROW row = bgr.ptr<unsigned char>(static_cast<int>(info.output_scanline) - roi.y);
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+
+    // Kalan satırlar okunmadığı için finish yerine abort
+    jpeg_abort_decompress(&info);
+    jpeg_destroy_decompress(&info);
+
+    offset = cv::Point(static_cast<int>(x_offset), roi.y);
+    return true;
+}
+#endif
+
+}
+
+bool readJpegSize(const cv::Mat& jpeg, cv::Size& size) {
+    const uchar* data = jpeg.ptr<uchar>();
+    size_t length = jpeg.total() * jpeg.elemSize();
+    if (length < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (data[pos] != 0xFF) return false;
+        uchar marker = data[pos + 1];
+        if (marker == 0xFF) {       // Dolgu baytı
+            pos++;
+            continue;
+        }
+        size_t segment_length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+
+        // SOF0..SOF15 (DHT = C4, JPG = C8, DAC = CC hariç)
+        bool is_sof = marker >= 0xC0 && marker <= 0xCF &&
+            marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (is_sof) {
+            if (pos + 9 > length) return false;
+            size.height = (data[pos + 5] << 8) | data[pos + 6];
+            size.width = (data[pos + 7] << 8) | data[pos + 8];
+            return true;
+        }
+        if (marker == 0xDA) return false;   // SOS: görüntü verisi başladı, SOF yok
+        pos += 2 + segment_length;
+    }
+    return false;
+}
+
+cv::Mat decodeJpegReducedGray(const cv::Mat& jpeg, int scale) {
+    int flags = cv::IMREAD_GRAYSCALE;
+    if (scale == 2) flags = cv::IMREAD_REDUCED_GRAYSCALE_2;
+    else if (scale == 4) flags = cv::IMREAD_REDUCED_GRAYSCALE_4;
+    else if (scale == 8) flags = cv::IMREAD_REDUCED_GRAYSCALE_8;
+
+    cv::Mat gray = cv::imdecode(jpeg, flags);
+    if (gray.empty()) {
+        throw std::runtime_error("Failed to decode MJPEG frame");
+    }
+    return gray;
+}
+
+void decodeJpegRegion(const cv::Mat& jpeg, const cv::Rect& region,
+    cv::Mat& bgr, cv::Point& offset) {
+#ifdef MOSAIC_WITH_LIBJPEG_TURBO
+    if (decodeRegionTurbo(jpeg, region, bgr, offset)) return;
+#endif
+
+    cv::Mat full = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+    if (full.empty()) {
+        throw std::runtime_error("Failed to decode MJPEG frame");
+    }
+    cv::Rect roi = region & cv::Rect(0, 0, full.cols, full.rows);
+    offset = roi.tl();
+    if (roi.empty()) {
+        bgr.release();
+        return;
+    }
+    bgr = full(roi);
+}
@@ -0,0 +1,80 @@
+﻿#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+    : data_(nullptr), size_(0), file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr) {
+    file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("Empty or unreadable file: " + path);
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+
+    mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping_handle_ == nullptr) {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+
+    data_ = static_cast<uint8_t*>(MapViewOfFile(mapping_handle_, FILE_MAP_COPY, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_handle_);
+        CloseHandle(file_handle_);
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_handle_);
+    CloseHandle(file_handle_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Empty or unreadable file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + path);
+    }
+    data_ = static_cast<uint8_t*>(data);
+}
+
+MappedFile::~MappedFile() {
+    munmap(data_, size_);
+}
+
+#endif
@@ -1,10 +1,19 @@
 ﻿#include "MarkerDetector.h"
 #include <algorithm>
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
 
 MarkerDetector::MarkerDetector(int target_id,
     const cv::aruco::Dictionary& dictionary,
     const cv::aruco::DetectorParameters& params)
-    : target_marker_id_(target_id), detector_(dictionary, params) {
+    : target_marker_ids_{ target_id }, detector_(dictionary, params) {
+}
+
+void MarkerDetector::setTargetIds(const std::vector<int>& ids) {
+    if (ids.empty()) {
+        throw std::runtime_error("At least one target marker ID is required!");
+    }
+    target_marker_ids_ = ids;
 }
 
 cv::Point2f MarkerDetector::getMarkerCenter(
@@ -18,19 +27,40 @@ cv::Point2f MarkerDetector::getMarkerCenter(
 
 bool MarkerDetector::detectMarkers(const cv::Mat& frame,
     std::vector<std::vector<cv::Point2f>>& target_corners) {
+    int board_id = -1;
+    return detectMarkers(frame, target_corners, board_id);
+}
+
+bool MarkerDetector::detectMarkers(const cv::Mat& frame,
+    std::vector<std::vector<cv::Point2f>>& target_corners, int& board_id) {
     std::vector<int> ids;
     std::vector<std::vector<cv::Point2f>> corners;
     detector_.detectMarkers(frame, corners, ids);
 
     target_corners.clear();
-    if (!ids.empty()) {
+    board_id = -1;
+    if (ids.empty()) {
+        return false;
+    }
+
+    // İlk tam tahta (dört köşe) kazanır; hiçbiri tam değilse en çok görülen ID'nin köşeleri döner
+    for (int target_id : target_marker_ids_) {
+        std::vector<std::vector<cv::Point2f>> matches;
         for (size_t i = 0; i < ids.size(); i++) {
-            if (ids[i] == target_marker_id_) {
-                target_corners.push_back(corners[i]);
+            if (ids[i] == target_id) {
+                matches.push_back(corners[i]);
             }
         }
+        if (matches.size() == 4) {
+            target_corners = std::move(matches);
+            board_id = target_id;
+            return true;
+        }
+        if (matches.size() > target_corners.size()) {
+            target_corners = std::move(matches);
+        }
     }
-    return target_corners.size() == 4;
+    return false;
 }
 
 std::vector<cv::Point2f> MarkerDetector::orderCorners(
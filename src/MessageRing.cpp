@@ -0,0 +1,124 @@
+﻿#include "MessageRing.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+    const uint32_t RING_MAGIC = 0x474E5252;  // "RRNG"
+    const uint32_t RING_VERSION = 1;
+
+    size_t slotStride(size_t slot_size) {
+        // Slotları cache line sınırına hizala
+        size_t stride = sizeof(MessageRingSlot) + slot_size;
+        return (stride + 63) & ~static_cast<size_t>(63);
+    }
+
+    size_t headerStride() {
+        return (sizeof(MessageRingHeader) + 63) & ~static_cast<size_t>(63);
+    }
+}
+
+MessageRingWriter::MessageRingWriter(const std::string& name, size_t slot_count, size_t slot_size)
+    : next_sequence_(0) {
+    if (slot_count == 0 || slot_size == 0) {
+        throw std::runtime_error("Message ring needs at least one non-empty slot!");
+    }
+
+    slot_stride_ = slotStride(slot_size);
+    region_ = SharedMemoryRegion::create(name, headerStride() + slot_count * slot_stride_);
+
+    uint8_t* base = static_cast<uint8_t*>(region_->data());
+    header_ = new (base) MessageRingHeader();
+    slots_ = base + headerStride();
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        MessageRingSlot* slot = new (slots_ + i * slot_stride_) MessageRingSlot();
+        slot->state.store(0, std::memory_order_relaxed);
+        slot->size = 0;
+    }
+
+    header_->slot_count = static_cast<uint32_t>(slot_count);
+    header_->slot_size = static_cast<uint32_t>(slot_size);
+    header_->version = RING_VERSION;
+    header_->write_sequence.store(0, std::memory_order_relaxed);
+
+    // Magic en son yazılır - okuyucular yarım başlatılmış halkaya bağlanmaz
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = RING_MAGIC;
+}
+
+bool MessageRingWriter::write(const uint8_t* data, size_t size) {
+    if (size > header_->slot_size) {
+        return false;
+    }
+
+    uint64_t seq = next_sequence_;
+    MessageRingSlot* slot = reinterpret_cast<MessageRingSlot*>(
+        slots_ + (seq % header_->slot_count) * slot_stride_);
+
+    slot->state.store(2 * seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(reinterpret_cast<uint8_t*>(slot) + sizeof(MessageRingSlot), data, size);
+    slot->size = static_cast<uint32_t>(size);
+
+    slot->state.store(2 * seq + 2, std::memory_order_release);
+    header_->write_sequence.store(seq + 1, std::memory_order_release);
+    next_sequence_ = seq + 1;
+    return true;
+}
+
+MessageRingReader::MessageRingReader(const std::string& name) {
+    region_ = SharedMemoryRegion::open(name);
+
+    const uint8_t* base = static_cast<const uint8_t*>(region_->data());
+    header_ = reinterpret_cast<const MessageRingHeader*>(base);
+    if (region_->size() < headerStride() || header_->magic != RING_MAGIC ||
+        header_->version != RING_VERSION) {
+        throw std::runtime_error("Not a message ring: " + name);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    slots_ = base + headerStride();
+    slot_stride_ = slotStride(header_->slot_size);
+    next_sequence_ = header_->write_sequence.load(std::memory_order_acquire);
+}
+
+RingReadResult MessageRingReader::read(std::vector<uint8_t>& out) {
+    uint64_t written = header_->write_sequence.load(std::memory_order_acquire);
+    if (next_sequence_ >= written) {
+        return RingReadResult::Empty;
+    }
+
+    // Yazar bir tur öne geçtiyse en eski sağlam mesaja atla
+    if (written - next_sequence_ > header_->slot_count) {
+        next_sequence_ = written - 1;
+        return RingReadResult::Overrun;
+    }
+
+    uint64_t seq = next_sequence_;
+    const MessageRingSlot* slot = reinterpret_cast<const MessageRingSlot*>(
+        slots_ + (seq % header_->slot_count) * slot_stride_);
+
+    uint64_t before = slot->state.load(std::memory_order_acquire);
+    if (before != 2 * seq + 2) {
+        next_sequence_ = header_->write_sequence.load(std::memory_order_acquire) - 1;
+        return RingReadResult::Overrun;
+    }
+
+    size_t size = slot->size;
+    if (size > header_->slot_size) size = header_->slot_size;
+    out.resize(size);
+    std::memcpy(out.data(), reinterpret_cast<const uint8_t*>(slot) + sizeof(MessageRingSlot), size);
+
+    // Kopyalama sırasında slot yeniden yazıldıysa veri bozuk olabilir
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = slot->state.load(std::memory_order_relaxed);
+    if (after != before) {
+        next_sequence_ = header_->write_sequence.load(std::memory_order_acquire) - 1;
+        return RingReadResult::Overrun;
+    }
+
+    next_sequence_ = seq + 1;
+    return RingReadResult::Message;
+}
@@ -0,0 +1,183 @@
+﻿#include "MetricsExporter.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Dışa aktarma thread'inin uyanma aralığı (HTTP isteği yoksa)
+const int EXPORTER_POLL_MS = 200;
+
+}
+
+// ===================== DIŞA AKTARAN THREAD =====================
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry, const MetricsConfig& config)
+    : registry_(registry), config_(config) {
+    if (config_.http_port > 0) {
+        openSocket();
+    }
+    if (!config_.json_path.empty()) {
+        std::cout << "Writing metrics to: " << config_.json_path << std::endl;
+    }
+    thread_ = std::thread(&MetricsExporter::loop, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop_ = true;
+    if (thread_.joinable()) thread_.join();
+
+#ifndef _WIN32
+    if (server_socket_ >= 0) close(server_socket_);
+#endif
+}
+
+void MetricsExporter::loop() {
+    auto next_json = std::chrono::steady_clock::now();
+    while (!stop_) {
+        registry_.tick(config_.window_seconds);
+
+        auto now = std::chrono::steady_clock::now();
+        if (!config_.json_path.empty() && now >= next_json) {
+            writeJson();
+            next_json = now + std::chrono::milliseconds(config_.json_interval_ms);
+        }
+
+        // Frame döngüsünden bağımsız: istek yoksa burada uyunur
+        serveClients(EXPORTER_POLL_MS);
+    }
+
+    // Son durum dosyada kalsın
+    if (!config_.json_path.empty()) writeJson();
+}
+
+void MetricsExporter::writeJson() {
+    // Okuyan taraf yarım dosya görmesin: geçici dosyaya yaz, üzerine taşı
+    std::string temp_path = config_.json_path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Warning: failed to write metrics file: " << temp_path << std::endl;
+            return;
+        }
+        out << registry_.renderJson();
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, config_.json_path, error);
+    if (error) {
+        std::cerr << "Warning: failed to replace metrics file: " << config_.json_path
+            << " (" << error.message() << ")" << std::endl;
+    }
+}
+
+#ifdef _WIN32
+
+void MetricsExporter::openSocket() {
+    std::cerr << "Warning: HTTP metrics endpoint is not supported on this platform, use the JSON file" << std::endl;
+}
+
+void MetricsExporter::serveClients(int timeout_ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+}
+
+#else
+
+void MetricsExporter::openSocket() {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.http_port));
+    if (inet_pton(AF_INET, config_.http_address.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid metrics address: " + config_.http_address);
+    }
+
+    server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_socket_ < 0) {
+        throw std::runtime_error("Failed to create metrics socket");
+    }
+
+    int on = 1;
+    setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(server_socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(server_socket_, 8) != 0) {
+        close(server_socket_);
+        server_socket_ = -1;
+        throw std::runtime_error("Failed to listen on metrics port: " + std::to_string(config_.http_port));
+    }
+
+    fcntl(server_socket_, F_SETFL, fcntl(server_socket_, F_GETFL, 0) | O_NONBLOCK);
+    std::cout << "Serving metrics on http://" << config_.http_address << ":"
+        << config_.http_port << "/metrics" << std::endl;
+}
+
+void MetricsExporter::serveClients(int timeout_ms) {
+    if (server_socket_ < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return;
+    }
+
+    pollfd server = { server_socket_, POLLIN, 0 };
+    if (poll(&server, 1, timeout_ms) <= 0) return;
+    while (true) {
+        int client = accept(server_socket_, nullptr, nullptr);
+        if (client < 0) break;
+
+        // Yavaş istemci sadece bu thread'i ve en fazla bu kadar bekletir
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) & ~O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        timeval timeout = { 0, 500 * 1000 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+            body = registry_.renderPrometheus();
+        }
+        else {
+            status = "404 Not Found";
+            body = "Not found\n";
+        }
+
+        std::string response = "HTTP/1.1 " + status +
+            "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+            std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        flags |= MSG_NOSIGNAL;
+#endif
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = send(client, response.data() + sent, response.size() - sent, flags);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        close(client);
+    }
+}
+
+#endif
@@ -0,0 +1,347 @@
+﻿#include "MetricsRegistry.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Pencere bu kadar parçaya bölünerek tutulur (60 s pencerede 5 s çözünürlük)
+const int WINDOW_SLICES = 12;
+
+const double QUANTILES[] = { 0.5, 0.9, 0.99 };
+
+std::vector<std::pair<std::string, std::string>> parseLabels(const std::string& labels) {
+    std::vector<std::pair<std::string, std::string>> result;
+    std::stringstream stream(labels);
+    std::string label;
+    while (std::getline(stream, label, ',')) {
+        size_t eq = label.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            throw std::runtime_error("Invalid metric label: " + label);
+        }
+        result.emplace_back(label.substr(0, eq), label.substr(eq + 1));
+    }
+    return result;
+}
+
+// Prometheus: name{a="1",quantile="0.5"}
+std::string prometheusLabels(const std::vector<std::pair<std::string, std::string>>& labels,
+    const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return "";
+    std::string text = "{";
+    for (const auto& label : labels) {
+        if (text.size() > 1) text += ",";
+        text += label.first + "=\"" + label.second + "\"";
+    }
+    if (!extra.empty()) {
+        if (text.size() > 1) text += ",";
+        text += extra;
+    }
+    return text + "}";
+}
+
+void writeNumber(std::ostream& out, double value, const char* nan_text) {
+    if (std::isnan(value)) out << nan_text;
+    else out << value;
+}
+
+const char* prometheusType(MetricsRegistry::Type type) {
+    switch (type) {
+    case MetricsRegistry::Type::Counter: return "counter";
+    case MetricsRegistry::Type::Histogram: return "summary";
+    default: return "gauge";
+    }
+}
+
+const char* jsonType(MetricsRegistry::Type type) {
+    switch (type) {
+    case MetricsRegistry::Type::Counter: return "counter";
+    case MetricsRegistry::Type::Histogram: return "summary";
+    case MetricsRegistry::Type::Rate: return "rate";
+    case MetricsRegistry::Type::Ratio: return "ratio";
+    default: return "gauge";
+    }
+}
+
+}
+
+// ===================== DAĞILIM =====================
+
+int MetricHistogram::bucketIndex(uint64_t value) {
+    if (value < 4) return static_cast<int>(value);
+
+    int octave = 2;
+    while (octave < 63 && (value >> (octave + 1)) != 0) octave++;
+    int sub = static_cast<int>((value >> (octave - 2)) & 3);
+    int index = 4 * (octave - 1) + sub;
+    return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+}
+
+uint64_t MetricHistogram::bucketLowerBound(int index) {
+    if (index < 4) return static_cast<uint64_t>(index);
+
+    int octave = index / 4 + 1;
+    return static_cast<uint64_t>(4 + index % 4) << (octave - 2);
+}
+
+void MetricHistogram::observe(uint64_t value) {
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+// ===================== KAYIT =====================
+
+MetricsRegistry::MetricsRegistry() : created_(std::chrono::steady_clock::now()) {
+}
+
+MetricCounter& MetricsRegistry::addCounter(const std::string& name, const std::string& help,
+    const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.push_back(std::make_unique<MetricCounter>());
+
+    Entry entry{ Type::Counter, name, parseLabels(labels), help };
+    entry.counter = counters_.back().get();
+    entries_.push_back(entry);
+    return *counters_.back();
+}
+
+MetricGauge& MetricsRegistry::addGauge(const std::string& name, const std::string& help,
+    const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gauges_.push_back(std::make_unique<MetricGauge>());
+
+    Entry entry{ Type::Gauge, name, parseLabels(labels), help };
+    entry.gauge = gauges_.back().get();
+    entries_.push_back(entry);
+    return *gauges_.back();
+}
+
+MetricHistogram& MetricsRegistry::addHistogram(const std::string& name, const std::string& help,
+    const std::string& labels, double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_.push_back(std::make_unique<MetricHistogram>());
+
+    Entry entry{ Type::Histogram, name, parseLabels(labels), help, scale };
+    entry.histogram = histograms_.back().get();
+    entries_.push_back(entry);
+
+    // Pencere kayıtları yeni dağılımı içermiyor
+    snapshots_.clear();
+    return *histograms_.back();
+}
+
+void MetricsRegistry::addRate(const std::string& name, const std::string& help,
+    const MetricCounter& counter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry{ Type::Rate, name, {}, help };
+    entry.counter = const_cast<MetricCounter*>(&counter);
+    entries_.push_back(entry);
+    snapshots_.clear();
+}
+
+void MetricsRegistry::addRatio(const std::string& name, const std::string& help,
+    const MetricCounter& numerator, const MetricCounter& denominator) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry{ Type::Ratio, name, {}, help };
+    entry.counter = const_cast<MetricCounter*>(&numerator);
+    entry.denominator = const_cast<MetricCounter*>(&denominator);
+    entries_.push_back(entry);
+    snapshots_.clear();
+}
+
+// ===================== PENCERE =====================
+
+MetricsRegistry::Snapshot MetricsRegistry::takeSnapshot() const {
+    Snapshot snapshot;
+    snapshot.time = std::chrono::steady_clock::now();
+    for (const auto& entry : entries_) {
+        if (entry.type == Type::Rate || entry.type == Type::Ratio) {
+            snapshot.counters.push_back(entry.counter->value());
+            snapshot.counters.push_back(entry.denominator ? entry.denominator->value() : 0);
+        }
+        else if (entry.type == Type::Histogram) {
+            std::vector<uint64_t> buckets(MetricHistogram::BUCKET_COUNT);
+            for (int i = 0; i < MetricHistogram::BUCKET_COUNT; ++i) {
+                buckets[i] = entry.histogram->bucket(i);
+            }
+            snapshot.histograms.push_back(std::move(buckets));
+        }
+    }
+    return snapshot;
+}
+
+void MetricsRegistry::tick(int window_seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    auto window = std::chrono::milliseconds(std::max(window_seconds, 1) * 1000);
+
+    if (snapshots_.empty() || now - snapshots_.back().time >= window / WINDOW_SLICES) {
+        snapshots_.push_back(takeSnapshot());
+    }
+    // En eski kayıt pencere başının hemen öncesinde kalır
+    while (snapshots_.size() > 1 && snapshots_[1].time <= now - window) {
+        snapshots_.pop_front();
+    }
+}
+
+const MetricsRegistry::Snapshot* MetricsRegistry::windowStart() const {
+    return snapshots_.empty() ? nullptr : &snapshots_.front();
+}
+
+double MetricsRegistry::windowValue(const Entry& entry, const Snapshot* start,
+    std::chrono::steady_clock::time_point now) const {
+    // Rate / Ratio kayıtlarının snapshot'taki yeri: kayıt sırasına göre 2 değer
+    size_t slot = 0;
+    for (const auto& other : entries_) {
+        if (&other == &entry) break;
+        if (other.type == Type::Rate || other.type == Type::Ratio) slot += 2;
+    }
+    uint64_t start_value = start ? start->counters[slot] : 0;
+    uint64_t start_denominator = start ? start->counters[slot + 1] : 0;
+    double delta = static_cast<double>(entry.counter->value() - start_value);
+
+    if (entry.type == Type::Rate) {
+        double seconds = std::chrono::duration<double>(now - (start ? start->time : created_)).count();
+        return seconds > 0 ? delta / seconds : 0.0;
+    }
+    double denominator = static_cast<double>(entry.denominator->value() - start_denominator);
+    return denominator > 0 ? delta / denominator : std::numeric_limits<double>::quiet_NaN();
+}
+
+double MetricsRegistry::quantile(const Entry& entry, const Snapshot* start, double q) const {
+    size_t slot = 0;
+    for (const auto& other : entries_) {
+        if (&other == &entry) break;
+        if (other.type == Type::Histogram) slot++;
+    }
+
+    uint64_t deltas[MetricHistogram::BUCKET_COUNT];
+    uint64_t total = 0;
+    for (int i = 0; i < MetricHistogram::BUCKET_COUNT; ++i) {
+        deltas[i] = entry.histogram->bucket(i) - (start ? start->histograms[slot][i] : 0);
+        total += deltas[i];
+    }
+    if (total == 0) return std::numeric_limits<double>::quiet_NaN();
+
+    // Sıralamadaki yer kovanın içinde doğrusal olarak yerleştirilir
+    double rank = q * total;
+    double seen = 0.0;
+    for (int i = 0; i < MetricHistogram::BUCKET_COUNT; ++i) {
+        if (deltas[i] == 0) continue;
+        if (seen + deltas[i] >= rank) {
+            double low = static_cast<double>(MetricHistogram::bucketLowerBound(i));
+            double high = i + 1 < MetricHistogram::BUCKET_COUNT ?
+                static_cast<double>(MetricHistogram::bucketLowerBound(i + 1)) : low;
+            double position = (rank - seen) / deltas[i];
+            return (low + (high - low) * position) * entry.scale;
+        }
+        seen += deltas[i];
+    }
+    return static_cast<double>(MetricHistogram::bucketLowerBound(MetricHistogram::BUCKET_COUNT - 1)) * entry.scale;
+}
+
+// ===================== DIŞA AKTARMA =====================
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    const Snapshot* start = windowStart();
+
+    std::ostringstream out;
+    std::vector<std::string> described;
+    for (const auto& entry : entries_) {
+        // Aynı isimli (farklı etiketli) metrikler tek HELP / TYPE altında
+        bool first = std::find(described.begin(), described.end(), entry.name) == described.end();
+        if (first) {
+            described.push_back(entry.name);
+            out << "# HELP " << entry.name << " " << entry.help << "\n";
+            out << "# TYPE " << entry.name << " " << prometheusType(entry.type) << "\n";
+        }
+
+        switch (entry.type) {
+        case Type::Counter:
+            out << entry.name << prometheusLabels(entry.labels) << " " << entry.counter->value() << "\n";
+            break;
+        case Type::Gauge:
+            out << entry.name << prometheusLabels(entry.labels) << " ";
+            writeNumber(out, entry.gauge->value(), "NaN");
+            out << "\n";
+            break;
+        case Type::Rate:
+        case Type::Ratio:
+            out << entry.name << prometheusLabels(entry.labels) << " ";
+            writeNumber(out, windowValue(entry, start, now), "NaN");
+            out << "\n";
+            break;
+        case Type::Histogram:
+            for (double q : QUANTILES) {
+                std::ostringstream label;
+                label << "quantile=\"" << q << "\"";
+                out << entry.name << prometheusLabels(entry.labels, label.str()) << " ";
+                writeNumber(out, quantile(entry, start, q), "NaN");
+                out << "\n";
+            }
+            out << entry.name << "_sum" << prometheusLabels(entry.labels) << " "
+                << entry.histogram->sum() * entry.scale << "\n";
+            out << entry.name << "_count" << prometheusLabels(entry.labels) << " "
+                << entry.histogram->count() << "\n";
+            break;
+        }
+    }
+    return out.str();
+}
+
+std::string MetricsRegistry::renderJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    const Snapshot* start = windowStart();
+    double window = std::chrono::duration<double>(now - (start ? start->time : created_)).count();
+    auto unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::ostringstream out;
+    out << "{\n  \"timestamp_ms\": " << unix_ms << ",\n  \"window_seconds\": " << window
+        << ",\n  \"metrics\": [";
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        const Entry& entry = entries_[i];
+        out << (i > 0 ? "," : "") << "\n    { \"name\": \"" << entry.name
+            << "\", \"type\": \"" << jsonType(entry.type) << "\"";
+        if (!entry.labels.empty()) {
+            out << ", \"labels\": {";
+            for (size_t j = 0; j < entry.labels.size(); ++j) {
+                out << (j > 0 ? ", " : " ") << "\"" << entry.labels[j].first << "\": \""
+                    << entry.labels[j].second << "\"";
+            }
+            out << " }";
+        }
+
+        switch (entry.type) {
+        case Type::Counter:
+            out << ", \"value\": " << entry.counter->value();
+            break;
+        case Type::Gauge:
+            out << ", \"value\": ";
+            writeNumber(out, entry.gauge->value(), "null");
+            break;
+        case Type::Rate:
+        case Type::Ratio:
+            out << ", \"value\": ";
+            writeNumber(out, windowValue(entry, start, now), "null");
+            break;
+        case Type::Histogram:
+            out << ", \"count\": " << entry.histogram->count()
+                << ", \"sum\": " << entry.histogram->sum() * entry.scale;
+            for (double q : QUANTILES) {
+                out << ", \"p" << static_cast<int>(std::lround(q * 100)) << "\": ";
+                writeNumber(out, quantile(entry, start, q), "null");
+            }
+            break;
+        }
+        out << " }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
@@ -0,0 +1,1011 @@
+﻿#include "MosaicEngine.h"
+#include "JpegDecode.h"
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <opencv2/imgproc.hpp>
+
+// Minimum fill ratio - bunun altındaki değerler beyaz olarak kabul edilir
+const float MIN_FILL_RATIO_THRESHOLD = 0.15f;  // %15
+
+// Template değişimi için gereken tutarlı gözlem süresi (30 fps'te 10 frame)
+const int64_t TEMPLATE_SWITCH_US = 320000;
+
+// Rotasyon değişimi için gereken tutarlı gözlem süresi (30 fps'te 6 frame)
+const int64_t ROTATION_SWITCH_US = 180000;
+
+// Tek bir frame'in oylamada temsil edebileceği en uzun süre: tahta bir süre
+// görünmeyip geri geldiğinde aradaki boşluk tek frame'e yazılmaz
+const int64_t MAX_OBSERVATION_SPAN_US = 100000;
+
+// Marker ID'siyle bilinen template'in görüntüden kontrol aralığı (frame)
+const uint64_t TEMPLATE_CHECK_INTERVAL = 30;
+
+// Birikimli modda warp boyutu bu kadar (en az WARP_SIZE_HYSTERESIS_PX) değişmedikçe korunur
+const int WARP_SIZE_HYSTERESIS_PX = 4;
+const double WARP_SIZE_HYSTERESIS_RATIO = 0.02;
+
+// Boşta modunda hareket karşılaştırmasının yapıldığı küçültme oranı
+const int MOTION_SCALE = 8;
+
+// Aktif modda tahtasız frame maliyetinin üstel ortalama katsayısı
+const double MISS_COST_SMOOTHING = 0.05;
+
+namespace {
+
+// Sabit kare boyut kullan - rotasyondan bağımsız tutarlılık için
+int boardWarpSize(const std::vector<cv::Point2f>& corners) {
+    float width1 = cv::norm(corners[1] - corners[0]);
+    float width2 = cv::norm(corners[2] - corners[3]);
+    float height1 = cv::norm(corners[3] - corners[0]);
+    float height2 = cv::norm(corners[2] - corners[1]);
+
+    int warp_width = static_cast<int>((width1 + width2) / 2.0f);
+    int warp_height = static_cast<int>((height1 + height2) / 2.0f);
+    return std::max(warp_width, warp_height);
+}
+
+std::vector<cv::Point2f> boardWarpPoints(int warp_size) {
+    return {
+        cv::Point2f(0, 0),
+        cv::Point2f(warp_size - 1, 0),
+        cv::Point2f(warp_size - 1, warp_size - 1),
+        cv::Point2f(0, warp_size - 1)
+    };
+}
+
+const char* const METRIC_STAGE_NAMES[] = {
+    "input", "markers", "warp", "template", "accumulate", "classify", "idle", "total"
+};
+
+}
+
+MosaicEngine::MosaicEngine(const std::vector<std::string>& template_paths,
+    const std::vector<std::string>& template_names,
+    int target_marker_id)
+    : current_template_index_(0),
+    detected_template_index_(0), template_vote_us_(0), target_marker_id_(target_marker_id),
+    current_rotation_(0) {
+
+    sampling_config_.min_fill_ratio = MIN_FILL_RATIO_THRESHOLD;
+    registerMetrics();
+
+    if (template_paths.empty()) {
+        throw std::runtime_error("At least one template path is required!");
+    }
+
+    template_names_ = template_names;
+
+    // İsim sayısı yeterli değilse varsayılan isimler ekle
+    while (template_names_.size() < template_paths.size()) {
+        template_names_.push_back("Template " + std::to_string(template_names_.size() + 1));
+    }
+
+    // Tüm template'leri yükle
+    for (size_t i = 0; i < template_paths.size(); ++i) {
+        try {
+            auto processor = std::make_unique<TemplateProcessor>(template_paths[i]);
+            template_processors_.push_back(std::move(processor));
+            renderers_.push_back(std::make_unique<DigitalRenderer>(*template_processors_.back()));
+            samplers_.push_back(std::make_unique<PatchSampler>(*template_processors_.back()));
+
+            // Her template için history oluştur
+            size_t num_contours = template_processors_.back()->getContours().size();
+            all_color_histories_.push_back(std::vector<ColorHistory>(num_contours));
+            all_ratio_histories_.push_back(std::vector<float>(num_contours, 0.0f));
+
+            std::cout << "Template loaded: " << template_names_[i]
+                << " (" << template_paths[i] << ")" << std::endl;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Warning: Could not load template " << template_paths[i]
+                << ": " << e.what() << std::endl;
+        }
+    }
+
+    if (template_processors_.empty()) {
+        throw std::runtime_error("No valid templates could be loaded!");
+    }
+
+    color_detector_ = std::make_unique<ColorDetector>();
+
+    cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_250);
+    cv::aruco::DetectorParameters params;
+    params.cornerRefinementMethod = cv::aruco::CORNER_REFINE_SUBPIX;
+    marker_detector_ = std::make_unique<MarkerDetector>(target_marker_id, dictionary, params);
+}
+
+void MosaicEngine::registerMetrics() {
+    metric_frames_processed_ = &metrics_.addCounter("mosaic_frames_processed_total",
+        "Frames passed through full-resolution marker detection and classification");
+    metric_frames_idle_ = &metrics_.addCounter("mosaic_frames_idle_total",
+        "Frames handled by idle scanning without full-resolution detection");
+    metric_board_found_ = &metrics_.addCounter("mosaic_frames_board_found_total",
+        "Frames with all four board markers found");
+    metric_template_switches_ = &metrics_.addCounter("mosaic_template_switches_total",
+        "Active template changes");
+    metric_rotation_changes_ = &metrics_.addCounter("mosaic_rotation_changes_total",
+        "Accepted board rotation changes");
+
+    metrics_.addRate("mosaic_processed_fps", "Processed frames per second over the window",
+        *metric_frames_processed_);
+    metrics_.addRatio("mosaic_board_found_ratio", "Fraction of processed frames with all four markers over the window",
+        *metric_board_found_, *metric_frames_processed_);
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        metric_stage_latency_[stage] = &metrics_.addHistogram("mosaic_stage_latency_seconds",
+            "Per-frame processing time by stage", std::string("stage=") + METRIC_STAGE_NAMES[stage], 1e-6);
+    }
+    metric_patches_changed_ = &metrics_.addHistogram("mosaic_patches_changed",
+        "Patches whose color changed from the previous visible frame");
+
+    metric_template_index_ = &metrics_.addGauge("mosaic_template_index", "Active template index");
+    metric_rotation_ = &metrics_.addGauge("mosaic_rotation_degrees", "Active board rotation");
+    metric_patch_count_ = &metrics_.addGauge("mosaic_patch_count", "Patches in the active template");
+
+    metric_idle_ = &metrics_.addGauge("mosaic_idle", "1 while the engine is in low-power idle scanning");
+    metric_state_seconds_[0] = &metrics_.addGauge("mosaic_state_seconds",
+        "Capture time spent in each engine state", "state=active");
+    metric_state_seconds_[1] = &metrics_.addGauge("mosaic_state_seconds",
+        "Capture time spent in each engine state", "state=idle");
+    metric_idle_saved_seconds_ = &metrics_.addGauge("mosaic_idle_cpu_saved_seconds",
+        "Estimated processing time saved by idle scanning");
+    metric_idle_scans_ = &metrics_.addCounter("mosaic_idle_scans_total",
+        "Reduced-resolution marker searches while idle");
+    metric_idle_entries_ = &metrics_.addCounter("mosaic_idle_entries_total",
+        "Transitions from active to idle scanning");
+    metric_distortion_lookups_ = &metrics_.addCounter("mosaic_distortion_lookup_builds_total",
+        "Lens distortion lookup tables built (once per frame size and calibration)");
+    metric_classifications_ = &metrics_.addCounter("mosaic_classifications_total",
+        "Frames whose patches were classified (all visible frames unless accumulating)");
+    metric_accumulator_resets_ = &metrics_.addCounter("mosaic_accumulator_resets_total",
+        "Board accumulator restarts (motion, warp size, template or rotation change)");
+}
+
+void MosaicEngine::setSamplingConfig(const SamplingConfig& config) {
+    sampling_config_ = config;
+    sampling_config_.min_fill_ratio = MIN_FILL_RATIO_THRESHOLD;
+}
+
+void MosaicEngine::setMjpegDetectionScale(int scale) {
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        throw std::runtime_error("MJPEG detection scale must be 1, 2, 4 or 8!");
+    }
+    mjpeg_detection_scale_ = scale;
+}
+
+void MosaicEngine::setCalibration(const CameraCalibration& calibration) {
+    calibration_ = calibration;
+    frame_calibration_ = CameraCalibration();
+    distortion_lookup_ = DistortionLookup();
+    warp_map_corners_.clear();
+}
+
+void MosaicEngine::updateFrameCalibration(cv::Size frame_size) {
+    if (frame_calibration_.valid() && frame_calibration_.imageSize() == frame_size) return;
+    frame_calibration_ = calibration_.scaledTo(frame_size);
+    distortion_lookup_ = DistortionLookup(frame_calibration_);
+    warp_map_corners_.clear();
+    metric_distortion_lookups_->add();
+}
+
+void MosaicEngine::setAccumulatorConfig(const AccumulatorConfig& config) {
+    accumulator_.configure(config);
+    accumulator_config_ = config;
+    accumulated_template_ = -1;
+    accumulated_rotation_ = -1;
+    frames_since_classify_ = 0;
+    held_warp_size_ = 0;
+}
+
+int MosaicEngine::stableWarpSize(int warp_size) {
+    int tolerance = std::max(WARP_SIZE_HYSTERESIS_PX,
+        static_cast<int>(held_warp_size_ * WARP_SIZE_HYSTERESIS_RATIO));
+    if (held_warp_size_ == 0 || std::abs(warp_size - held_warp_size_) > tolerance) {
+        held_warp_size_ = warp_size;
+    }
+    return held_warp_size_;
+}
+
+void MosaicEngine::setIdleConfig(const IdleConfig& config) {
+    if (config.scan_scale != 1 && config.scan_scale != 2 && config.scan_scale != 4 && config.scan_scale != 8) {
+        throw std::runtime_error("Idle scan scale must be 1, 2, 4 or 8!");
+    }
+    if (config.idle_after_frames < 1 || config.min_scan_interval_ms < 1 ||
+        config.max_scan_interval_ms < config.min_scan_interval_ms) {
+        throw std::runtime_error("Invalid idle scanning configuration!");
+    }
+    idle_config_ = config;
+    frames_without_board_ = 0;
+    if (!config.enabled && idle_) {
+        idle_ = false;
+        metric_idle_->set(0.0);
+    }
+}
+
+void MosaicEngine::printIdleStats() const {
+    if (!idle_config_.enabled) return;
+
+    std::cout << "Idle: active " << state_seconds_[0] << " s (" << state_frames_[0] << " frames), idle "
+        << state_seconds_[1] << " s (" << state_frames_[1] << " frames, " << metric_idle_scans_->value()
+        << " scans), processing saved ~" << idle_saved_us_ * 1e-6 << " s" << std::endl;
+}
+
+void MosaicEngine::setKeepImages(bool keep) {
+    keep_images_ = keep;
+    if (!keep) images_ = EngineImages();
+}
+
+void MosaicEngine::printTemplates() const {
+    std::cout << "Templates loaded: " << template_processors_.size() << std::endl;
+    for (size_t i = 0; i < template_names_.size() && i < template_processors_.size(); ++i) {
+        std::cout << "  " << (i + 1) << ". " << template_names_[i] << std::endl;
+    }
+    if (marker_templates_.empty()) {
+        std::cout << "\nAutomatic template detection: ENABLED" << std::endl;
+    }
+    else {
+        std::cout << "\nTemplate from marker IDs:";
+        for (const auto& entry : marker_templates_) {
+            std::cout << " " << entry.first << "=" << template_names_[entry.second];
+        }
+        std::cout << " (image check every " << TEMPLATE_CHECK_INTERVAL << " frames)" << std::endl;
+    }
+}
+
+void MosaicEngine::printSamplingStats() {
+    if (stats_pixels_total_ == 0) return;
+
+    std::cout << "Sampling: " << stats_pixels_visited_ << " / " << stats_pixels_total_
+        << " pixels visited (" << (100.0 * stats_pixels_visited_ / stats_pixels_total_) << "%)"
+        << (sampling_config_.enabled ? "" : " [exact]") << std::endl;
+
+    stats_pixels_visited_ = 0;
+    stats_pixels_total_ = 0;
+}
+
+void MosaicEngine::setTemplateMarkerIds(const std::vector<int>& marker_ids) {
+    if (marker_ids.size() > template_processors_.size()) {
+        throw std::runtime_error("More template marker IDs than loaded templates!");
+    }
+
+    marker_templates_.clear();
+    for (size_t i = 0; i < marker_ids.size(); ++i) {
+        if (!marker_templates_.emplace(marker_ids[i], static_cast<int>(i)).second) {
+            throw std::runtime_error("Duplicate template marker ID: " + std::to_string(marker_ids[i]));
+        }
+    }
+
+    // Eşlenmemiş eski tahtalar (varsayılan ID) görüntüden tanımayla çalışmaya devam eder
+    std::vector<int> target_ids = marker_ids;
+    if (marker_templates_.count(target_marker_id_) == 0) {
+        target_ids.push_back(target_marker_id_);
+    }
+    marker_detector_->setTargetIds(target_ids);
+}
+
+bool DetectorState::operator==(const DetectorState& other) const {
+    return current_template_index == other.current_template_index &&
+        detected_template_index == other.detected_template_index &&
+        template_vote_us == other.template_vote_us &&
+        current_rotation == other.current_rotation &&
+        rotation_vote_us == other.rotation_vote_us &&
+        last_observation_us == other.last_observation_us &&
+        color_samples == other.color_samples;
+}
+
+DetectorState MosaicEngine::getState() const {
+    DetectorState state;
+    state.current_template_index = current_template_index_;
+    state.detected_template_index = detected_template_index_;
+    state.template_vote_us = template_vote_us_;
+    state.current_rotation = current_rotation_;
+    state.rotation_vote_us = rotation_vote_us_;
+    state.last_observation_us = last_observation_us_;
+    state.color_samples.resize(all_color_histories_.size());
+    for (size_t t = 0; t < all_color_histories_.size(); ++t) {
+        for (const auto& history : all_color_histories_[t]) {
+            state.color_samples[t].push_back(history.getSamples());
+        }
+    }
+    return state;
+}
+
+void MosaicEngine::setState(const DetectorState& state) {
+    current_template_index_ = state.current_template_index;
+    detected_template_index_ = state.detected_template_index;
+    template_vote_us_ = state.template_vote_us;
+    current_rotation_ = state.current_rotation;
+    rotation_vote_us_ = state.rotation_vote_us;
+    last_observation_us_ = state.last_observation_us;
+
+    for (size_t t = 0; t < all_color_histories_.size() && t < state.color_samples.size(); ++t) {
+        auto& color_histories = all_color_histories_[t];
+        for (size_t i = 0; i < color_histories.size() && i < state.color_samples[t].size(); ++i) {
+            color_histories[i].setSamples(state.color_samples[t][i]);
+        }
+    }
+}
+
+void MosaicEngine::switchTemplate(int index) {
+    if (index >= 0 && index < static_cast<int>(template_processors_.size()) &&
+        index != current_template_index_) {
+        current_template_index_ = index;
+        metric_template_switches_->add();
+        std::cout << "Auto-switched to: " << template_names_[index] << std::endl;
+    }
+}
+
+void MosaicEngine::resetHistories(int index) {
+    if (index >= 0 && index < static_cast<int>(all_color_histories_.size())) {
+        for (auto& history : all_color_histories_[index]) {
+            history.clear();
+        }
+        std::fill(all_ratio_histories_[index].begin(),
+            all_ratio_histories_[index].end(), 0.0f);
+    }
+}
+
+void MosaicEngine::resetHistories() {
+    resetHistories(current_template_index_);
+}
+
+cv::Point MosaicEngine::calculateContourCentroid(const std::vector<cv::Point>& contour) {
+    cv::Moments m = cv::moments(contour);
+    if (m.m00 == 0) {
+        cv::Rect br = cv::boundingRect(contour);
+        return cv::Point(br.x + br.width / 2, br.y + br.height / 2);
+    }
+    return cv::Point(static_cast<int>(m.m10 / m.m00), static_cast<int>(m.m01 / m.m00));
+}
+
+int MosaicEngine::detectRotation(const std::vector<std::vector<cv::Point2f>>& markers) {
+    if (markers.size() != 4) return 0;
+
+    const auto& first_marker = markers[0];
+    cv::Point2f marker_center(0, 0);
+    for (const auto& pt : first_marker) {
+        marker_center += pt;
+    }
+    marker_center *= 0.25f;
+
+    cv::Point2f corner0_dir = first_marker[0] - marker_center;
+
+    float angle = std::atan2(corner0_dir.y, corner0_dir.x) * 180.0f / CV_PI;
+
+    if (angle < 0) angle += 360.0f;
+
+    if (angle >= 180.0f && angle < 270.0f) {
+        return 0;
+    }
+    else if (angle >= 270.0f && angle < 360.0f) {
+        return 90;
+    }
+    else if (angle >= 0.0f && angle < 90.0f) {
+        return 180;
+    }
+    else {
+        return 270;
+    }
+}
+
+cv::Mat MosaicEngine::rotateImageInverse(const cv::Mat& image, int rotation) {
+    if (rotation == 0) {
+        return image.clone();
+    }
+
+    cv::Mat rotated;
+
+    if (rotation == 90) {
+        cv::rotate(image, rotated, cv::ROTATE_90_COUNTERCLOCKWISE);
+    }
+    else if (rotation == 180) {
+        cv::rotate(image, rotated, cv::ROTATE_180);
+    }
+    else if (rotation == 270) {
+        cv::rotate(image, rotated, cv::ROTATE_90_CLOCKWISE);
+    }
+    else {
+        return image.clone();
+    }
+
+    return rotated;
+}
+
+double MosaicEngine::calculateTemplateSimilarity(const cv::Mat& warped_lines, int template_index) {
+    if (template_index < 0 || template_index >= static_cast<int>(template_processors_.size())) {
+        return 0.0;
+    }
+
+    // Template'in siyah çizgilerini al
+    cv::Mat template_lines = template_processors_[template_index]->getTemplateLines();
+
+    // Aynı boyuta getir
+    cv::Mat template_resized;
+    cv::resize(template_lines, template_resized, warped_lines.size(), 0, 0, cv::INTER_NEAREST);
+
+    // Her iki maske de binary olmalı
+    cv::Mat warped_binary, template_binary;
+
+    if (warped_lines.channels() > 1) {
+        cv::cvtColor(warped_lines, warped_binary, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        warped_binary = warped_lines.clone();
+    }
+
+    if (template_resized.channels() > 1) {
+        cv::cvtColor(template_resized, template_binary, cv::COLOR_BGR2GRAY);
+    }
+    else {
+        template_binary = template_resized.clone();
+    }
+
+    // Binary threshold
+    cv::threshold(warped_binary, warped_binary, 127, 255, cv::THRESH_BINARY);
+    cv::threshold(template_binary, template_binary, 127, 255, cv::THRESH_BINARY);
+
+    // Intersection over Union (IoU) benzeri metrik
+    cv::Mat intersection, union_mask;
+    cv::bitwise_and(warped_binary, template_binary, intersection);
+    cv::bitwise_or(warped_binary, template_binary, union_mask);
+
+    double intersection_count = cv::countNonZero(intersection);
+    double union_count = cv::countNonZero(union_mask);
+
+    if (union_count == 0) return 0.0;
+
+    return intersection_count / union_count;
+}
+
+void MosaicEngine::applyMarkerTemplate(int board_id, int template_index,
+    const cv::Mat& warped_normalized) {
+    // Oylama yok: tahta ilk görüldüğü frame'de geçerli template'e geçilir
+    switchTemplate(template_index);
+    detected_template_index_ = template_index;
+    template_vote_us_ = 0;
+
+    // Görüntüden tanıma sadece yanlış basılmış / yanlış eşlenmiş marker'ları yakalamak için
+    if (++marker_template_frames_ % TEMPLATE_CHECK_INTERVAL != 0) return;
+
+    int image_template = detectTemplate(warped_normalized);
+    if (image_template != template_index) {
+        template_check_mismatches_++;
+        std::cerr << "Warning: marker " << board_id << " maps to " << template_names_[template_index]
+            << " but the board looks like " << template_names_[image_template]
+            << " (" << template_check_mismatches_ << " mismatches)" << std::endl;
+    }
+}
+
+int MosaicEngine::detectTemplate(const cv::Mat& warped_normalized) {
+    if (template_processors_.size() <= 1) {
+        return 0;  // Tek template varsa o
+    }
+
+    // Warped görüntüden siyah çizgileri çıkar
+    cv::Mat gray;
+    cv::cvtColor(warped_normalized, gray, cv::COLOR_BGR2GRAY);
+
+    // Siyah çizgileri bul (düşük değerli pikseller)
+    cv::Mat warped_lines;
+    cv::threshold(gray, warped_lines, 60, 255, cv::THRESH_BINARY_INV);
+
+    // Gürültüyü azalt
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    cv::morphologyEx(warped_lines, warped_lines, cv::MORPH_CLOSE, kernel);
+
+    // Her template ile karşılaştır
+    double best_similarity = 0.0;
+    int best_index = 0;
+
+    for (size_t i = 0; i < template_processors_.size(); ++i) {
+        double similarity = calculateTemplateSimilarity(warped_lines, static_cast<int>(i));
+
+        if (similarity > best_similarity) {
+            best_similarity = similarity;
+            best_index = static_cast<int>(i);
+        }
+    }
+
+    return best_index;
+}
+
+cv::Mat MosaicEngine::extractBoard(const FrameView& frame,
+    const std::vector<cv::Point2f>& corners, int warp_size) {
+    if (calibration_.valid()) {
+        return extractBoardUndistorted(frame, corners, warp_size);
+    }
+    if (frame.format == PixelFormat::BGR) {
+        return applyPerspectiveTransform(frame.data, corners, warp_size);
+    }
+
+    // Sadece tahtayı kapsayan bölge BGR'ye çevrilir (bilinear komşuluk için 2 piksel pay)
+    cv::Rect region = cv::boundingRect(corners);
+    region.x -= 2;
+    region.y -= 2;
+    region.width += 4;
+    region.height += 4;
+
+    cv::Mat region_bgr;
+    cv::Point offset;
+    convertRegionToBGR(frame, region, region_bgr, offset);
+
+    std::vector<cv::Point2f> local_corners;
+    for (const auto& corner : corners) {
+        local_corners.push_back(cv::Point2f(corner.x - offset.x, corner.y - offset.y));
+    }
+    return applyPerspectiveTransform(region_bgr, local_corners, warp_size);
+}
+
+cv::Mat MosaicEngine::extractBoardUndistorted(const FrameView& frame,
+    const std::vector<cv::Point2f>& corners, int warp_size) {
+    // Lens tablosu frame boyutuna bağlıdır; homografi her frame'in kendi köşeleriyle eklenir.
+    // Önceki tablo sadece köşeler birebir aynıysa kullanılır, yani sonuç önceki frame'lere
+    // bağlı değildir.
+    if (corners != warp_map_corners_ || warp_map_size_ != warp_size) {
+        cv::Mat to_frame = cv::getPerspectiveTransform(boardWarpPoints(warp_size), corners);
+        warp_map_region_ = distortion_lookup_.composeWarp(cv::Matx33d(to_frame.ptr<double>()),
+            cv::Size(warp_size, warp_size)) & cv::Rect(0, 0, frame.width, frame.height);
+        warp_map_corners_ = corners;
+        warp_map_size_ = warp_size;
+        warp_map_fixed_.release();
+    }
+
+    // BGR'de tablo doğrudan frame'i okur; diğer formatlarda sadece tablonun okuduğu
+    // bölge BGR'ye çevrilir (bilinear komşuluk için 2 piksel pay)
+    cv::Mat source;
+    cv::Point offset(0, 0);
+    if (frame.format == PixelFormat::BGR) {
+        source = frame.data;
+    }
+    else {
+        if (warp_map_region_.empty()) {
+            // Tahta tamamen kamera görüşü dışında
+            return cv::Mat(warp_size, warp_size, CV_8UC3, cv::Scalar(255, 255, 255));
+        }
+        cv::Rect region = warp_map_region_;
+        region.x -= 2;
+        region.y -= 2;
+        region.width += 4;
+        region.height += 4;
+        convertRegionToBGR(frame, region, source, offset);
+    }
+
+    if (warp_map_fixed_.empty() || offset != warp_map_offset_) {
+        distortion_lookup_.buildWarpMap(offset, warp_map_fixed_, warp_map_fraction_);
+        warp_map_offset_ = offset;
+    }
+
+    cv::Mat warped;
+    cv::remap(source, warped, warp_map_fixed_, warp_map_fraction_, cv::INTER_LINEAR,
+        cv::BORDER_CONSTANT, cv::Scalar(255, 255, 255));
+    return warped;
+}
+
+cv::Mat MosaicEngine::applyPerspectiveTransform(
+    const cv::Mat& frame,
+    const std::vector<cv::Point2f>& src_points, int warp_size) {
+
+    std::vector<cv::Point2f> dst_points = boardWarpPoints(warp_size);
+
+    cv::Mat M = cv::getPerspectiveTransform(src_points, dst_points);
+    cv::Mat warped;
+    cv::warpPerspective(frame, warped, M, cv::Size(warp_size, warp_size),
+        cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(255, 255, 255));
+
+    return warped;
+}
+
+int64_t MosaicEngine::observationSpan(int64_t timestamp_us) {
+    // İlk gözlemin veya zaman geriye gittiğinde (kaynak değişimi) önceki frame bilinmiyor
+    int64_t span = 0;
+    if (last_observation_us_ >= 0 && timestamp_us >= last_observation_us_) {
+        span = std::min(timestamp_us - last_observation_us_, MAX_OBSERVATION_SPAN_US);
+    }
+    last_observation_us_ = timestamp_us;
+    return span;
+}
+
+void MosaicEngine::enterIdle(int64_t timestamp_us) {
+    idle_ = true;
+    idle_scan_interval_us_ = static_cast<int64_t>(idle_config_.min_scan_interval_ms) * 1000;
+    last_idle_scan_us_ = timestamp_us;
+    next_idle_scan_us_ = timestamp_us + idle_scan_interval_us_;
+    motion_reference_.release();
+    metric_idle_->set(1.0);
+    metric_idle_entries_->add();
+}
+
+bool MosaicEngine::detectMotion(const FrameView& frame) {
+    // Her frame'de çalışır: tam decode / renk dönüşümü yok, 1/8 gri küçük görüntü
+    if (frame.format == PixelFormat::MJPEG) {
+        motion_thumbnail_ = decodeJpegReducedGray(frame.data, MOTION_SCALE);
+    }
+    else {
+        cv::Mat source = frame.format == PixelFormat::NV12 ? frame.data.rowRange(0, frame.height) : frame.data;
+        cv::Size size(std::max(1, frame.width / MOTION_SCALE), std::max(1, frame.height / MOTION_SCALE));
+        cv::Mat sampled;
+        cv::resize(source, sampled, size, 0, 0, cv::INTER_NEAREST);
+        if (sampled.channels() == 3) cv::cvtColor(sampled, motion_thumbnail_, cv::COLOR_BGR2GRAY);
+        else if (sampled.channels() == 2) cv::extractChannel(sampled, motion_thumbnail_, 0);
+        else motion_thumbnail_ = sampled;
+    }
+
+    // Referans son taramanın görüntüsü: yavaş hareketler de zamanla birikip eşiği geçer
+    if (motion_reference_.empty()) {
+        motion_thumbnail_.copyTo(motion_reference_);
+        return false;
+    }
+    if (motion_reference_.size() != motion_thumbnail_.size()) return true;
+
+    double mean_difference = cv::norm(motion_thumbnail_, motion_reference_, cv::NORM_L1) /
+        static_cast<double>(motion_thumbnail_.total());
+    return mean_difference > idle_config_.motion_threshold;
+}
+
+bool MosaicEngine::scanIdle(const FrameView& frame, int64_t timestamp_us) {
+    int64_t min_interval_us = static_cast<int64_t>(idle_config_.min_scan_interval_ms) * 1000;
+    int64_t max_interval_us = static_cast<int64_t>(idle_config_.max_scan_interval_ms) * 1000;
+
+    // Zaman geriye gittiyse (kaynak değişimi) takvim geçersiz: hemen taranır
+    if (timestamp_us < last_idle_scan_us_) {
+        last_idle_scan_us_ = timestamp_us;
+        next_idle_scan_us_ = timestamp_us;
+    }
+
+    // Hareket: aralık en kısaya döner. Hareket sürdükçe tarama en fazla min aralıkla yapılır.
+    if (detectMotion(frame)) {
+        next_idle_scan_us_ = std::min(next_idle_scan_us_, last_idle_scan_us_ + min_interval_us);
+        idle_scan_interval_us_ = min_interval_us;
+    }
+    if (timestamp_us < next_idle_scan_us_) {
+        marker_search_ran_ = false;
+        return false;
+    }
+    marker_search_ran_ = true;
+    last_idle_scan_us_ = timestamp_us;
+    metric_idle_scans_->add();
+
+    cv::Mat scan_image;
+    int scan_scale = idle_config_.scan_scale;
+    if (frame.format == PixelFormat::MJPEG) {
+        scan_scale = std::min(8, mjpeg_detection_scale_ * idle_config_.scan_scale);
+        scan_image = decodeJpegReducedGray(frame.data, scan_scale);
+    }
+    else if (scan_scale > 1) {
+        cv::resize(lumaPlane(frame), scan_image, cv::Size(frame.width / scan_scale, frame.height / scan_scale),
+            0, 0, cv::INTER_AREA);
+    }
+    else {
+        scan_image = lumaPlane(frame);
+    }
+
+    std::vector<std::vector<cv::Point2f>> target_corners;
+    int board_id = -1;
+    bool found = marker_detector_->detectMarkers(scan_image, target_corners, board_id);
+    motion_thumbnail_.copyTo(motion_reference_);
+
+    if (keep_images_) {
+        images_.detection_image = scan_image;
+        images_.detection_scale = scan_scale;
+        images_.corners.clear();
+        images_.warped.release();
+    }
+
+    if (found) {
+        // Tahta geri geldi: bu frame tam çözünürlükte yeniden işlenir
+        idle_ = false;
+        frames_without_board_ = 0;
+        metric_idle_->set(0.0);
+        return true;
+    }
+
+    next_idle_scan_us_ = timestamp_us + idle_scan_interval_us_;
+    idle_scan_interval_us_ = std::min(idle_scan_interval_us_ * 2, max_interval_us);
+    return false;
+}
+
+void MosaicEngine::accountFrame(int64_t timestamp_us, bool was_idle, bool found, uint64_t cost_us) {
+    // Frame'ler arası süre, frame başındaki duruma yazılır
+    int state = was_idle ? 1 : 0;
+    if (last_frame_us_ >= 0 && timestamp_us > last_frame_us_) {
+        state_seconds_[state] += (timestamp_us - last_frame_us_) * 1e-6;
+    }
+    last_frame_us_ = timestamp_us;
+    state_frames_[state]++;
+
+    if (!was_idle && !found) {
+        double cost = static_cast<double>(cost_us);
+        active_miss_cost_us_ = active_miss_cost_us_ == 0.0 ? cost :
+            active_miss_cost_us_ + MISS_COST_SMOOTHING * (cost - active_miss_cost_us_);
+    }
+    else if (was_idle) {
+        idle_saved_us_ += std::max(0.0, active_miss_cost_us_ - static_cast<double>(cost_us));
+    }
+
+    metric_state_seconds_[state]->set(state_seconds_[state]);
+    metric_idle_saved_seconds_->set(idle_saved_us_ * 1e-6);
+}
+
+void MosaicEngine::classifyPatches(const cv::Mat& warped_frame, int64_t timestamp_us,
+    std::vector<PatchInfo>& patch_infos) {
+    patch_infos.clear();
+
+    auto& sampler = samplers_[current_template_index_];
+    auto& color_histories = all_color_histories_[current_template_index_];
+    auto& ratio_histories = all_ratio_histories_[current_template_index_];
+
+    // Aşındırılmış patch maskeleri warp boyutu değişene kadar önbellekte
+    sampler->prepare(warped_frame.size());
+
+    for (size_t i = 0; i < sampler->patchCount(); ++i) {
+        ColorDetectionResult detection = color_detector_->detectColorSampled(
+            warped_frame, sampler->samplePoints(i), sampling_config_);
+
+        stats_pixels_visited_ += detection.pixels_visited;
+        stats_pixels_total_ += detection.pixels_total;
+
+        cv::Scalar color_to_draw;
+        float current_ratio = detection.fill_ratio;
+        std::string current_color_name = detection.color_name;
+
+        bool is_white = (detection.color[0] == 255 &&
+            detection.color[1] == 255 &&
+            detection.color[2] == 255);
+
+        bool is_below_threshold = (current_ratio < MIN_FILL_RATIO_THRESHOLD);
+
+        if (is_white || is_below_threshold) {
+            color_histories[i].clear();
+            color_to_draw = cv::Scalar(255, 255, 255);
+            ratio_histories[i] = 0.0f;
+            current_color_name = "White";
+            current_ratio = 0.0f;
+        }
+        else {
+            color_histories[i].addColor(detection.color, timestamp_us);
+            color_to_draw = color_histories[i].getStableColor();
+            // Yayınlanan sınıf da kararlı renkten gelir; tek frame'lik titreme sonucu değiştirmez
+            current_color_name = color_detector_->getColorName(color_to_draw);
+            // Smoothing yok - anlık değer
+            ratio_histories[i] = current_ratio;
+        }
+
+        PatchInfo info;
+        info.patch_id = static_cast<int>(i);
+        info.color_name = current_color_name;
+        info.color = color_to_draw;
+        info.fill_ratio = ratio_histories[i];
+        info.centroid = calculateContourCentroid(sampler->scaledContour(i));
+        info.pixels_visited = detection.pixels_visited;
+        info.pixels_total = detection.pixels_total;
+        patch_infos.push_back(info);
+    }
+}
+
+void MosaicEngine::fillBoardState(const std::vector<PatchInfo>& patch_infos, BoardState& result) {
+    result.board_visible = true;
+    result.template_index = current_template_index_;
+    result.rotation = current_rotation_;
+
+    result.patches.resize(patch_infos.size());
+    for (size_t i = 0; i < patch_infos.size(); ++i) {
+        result.patches[i].color = patchColorFromName(patch_infos[i].color_name);
+        result.patches[i].fill_ratio = patch_infos[i].fill_ratio;
+    }
+
+    size_t changed = 0;
+    metric_patch_colors_.resize(patch_infos.size(), PatchColor::White);
+    for (size_t i = 0; i < patch_infos.size(); ++i) {
+        if (metric_patch_colors_[i] != result.patches[i].color) {
+            metric_patch_colors_[i] = result.patches[i].color;
+            changed++;
+        }
+    }
+    metric_patches_changed_->observe(changed);
+    metric_patch_count_->set(static_cast<double>(patch_infos.size()));
+}
+
+bool MosaicEngine::process(const FrameView& frame, int64_t timestamp_us, BoardState& result) {
+    MetricTimer frame_timer;
+    MetricTimer stage_timer;
+    bool was_idle = idle_;
+
+    // Tahta bulunamazsa bu frame'in sonucu "görünmüyor" olarak kalır
+    result.frame_index = frame_counter_++;
+    result.timestamp_us = timestamp_us;
+    result.board_visible = false;
+    result.template_index = current_template_index_;
+    result.rotation = current_rotation_;
+    result.patches.clear();
+
+    // Boşta: hareket yoksa ve tarama zamanı gelmediyse frame'e dokunulmaz
+    if (idle_) {
+        bool board_back = scanIdle(frame, timestamp_us);
+        stage_timer.lap(*metric_stage_latency_[STAGE_IDLE]);
+        if (!board_back) {
+            metric_frames_idle_->add();
+            accountFrame(timestamp_us, was_idle, false, frame_timer.lap(*metric_stage_latency_[STAGE_TOTAL]));
+            return false;
+        }
+    }
+    marker_search_ran_ = true;
+    metric_frames_processed_->add();
+
+    // BGR'de ArUco griye kendisi çevirir; YUV'de Y düzlemi dönüşümsüz kullanılır.
+    // MJPEG'de tespit DCT ölçeklemeli küçük gri decode üzerinde yapılır.
+    cv::Mat detection_image;
+    int detection_scale = 1;
+    if (frame.format == PixelFormat::MJPEG) {
+        detection_scale = mjpeg_detection_scale_;
+        detection_image = decodeJpegReducedGray(frame.data, detection_scale);
+    }
+    else {
+        detection_image = lumaPlane(frame);
+    }
+    stage_timer.lap(*metric_stage_latency_[STAGE_INPUT]);
+
+    std::vector<std::vector<cv::Point2f>> target_corners;
+    int board_id = -1;
+    bool found = marker_detector_->detectMarkers(detection_image, target_corners, board_id);
+    stage_timer.lap(*metric_stage_latency_[STAGE_MARKERS]);
+
+    if (found && detection_scale > 1) {
+        // Küçük görüntüdeki piksel merkezi, tam çözünürlükte s*x + (s-1)/2'ye denk gelir
+        float pixel_center = (detection_scale - 1) * 0.5f;
+        for (auto& marker : target_corners) {
+            for (auto& pt : marker) {
+                pt = cv::Point2f(pt.x * detection_scale + pixel_center, pt.y * detection_scale + pixel_center);
+            }
+        }
+    }
+
+    if (found && calibration_.valid()) {
+        // Köşeler bozulmasız piksel koordinatlarına: tahta kenarları yeniden düz çizgi olur
+        updateFrameCalibration(cv::Size(frame.width, frame.height));
+        for (auto& marker : target_corners) {
+            frame_calibration_.undistortPoints(marker);
+        }
+    }
+
+    if (keep_images_) {
+        images_.detection_image = detection_image;
+        images_.detection_scale = detection_scale;
+        images_.corners.clear();
+        images_.warped.release();
+    }
+
+    if (found) {
+        metric_board_found_->add();
+        int detected_rotation = detectRotation(target_corners);
+        int64_t span_us = observationSpan(timestamp_us);
+
+        if (detected_rotation != current_rotation_) {
+            rotation_vote_us_ += span_us;
+            if (rotation_vote_us_ >= ROTATION_SWITCH_US) {
+                current_rotation_ = detected_rotation;
+                rotation_vote_us_ = 0;
+                metric_rotation_changes_->add();
+                // Rotasyon değiştiğinde ratio history'yi sıfırla
+                for (auto& ratio : all_ratio_histories_[current_template_index_]) {
+                    ratio = 0.0f;
+                }
+            }
+        }
+        else {
+            rotation_vote_us_ = 0;
+        }
+
+        auto corners = marker_detector_->orderCorners(target_corners);
+
+        int warp_size = boardWarpSize(corners);
+        if (accumulator_config_.enabled) {
+            warp_size = stableWarpSize(warp_size);
+        }
+        cv::Mat warped = extractBoard(frame, corners, warp_size);
+        cv::Mat warped_normalized = rotateImageInverse(warped, current_rotation_);
+        stage_timer.lap(*metric_stage_latency_[STAGE_WARP]);
+
+        if (keep_images_) {
+            images_.corners = corners;
+            if (calibration_.valid()) {
+                // Gösterim bozuk frame üzerinde
+                for (auto& corner : images_.corners) {
+                    corner = frame_calibration_.distortPoint(corner.x, corner.y);
+                }
+            }
+            images_.warped = warped;
+        }
+
+        auto marker_template = marker_templates_.find(board_id);
+        if (marker_template != marker_templates_.end()) {
+            applyMarkerTemplate(board_id, marker_template->second, warped_normalized);
+        }
+        else {
+            // Otomatik template algılama
+            int detected_template = detectTemplate(warped_normalized);
+
+            if (detected_template != detected_template_index_) {
+                detected_template_index_ = detected_template;
+                template_vote_us_ = span_us;
+            }
+            else {
+                template_vote_us_ += span_us;
+            }
+
+            // Belirli süre tutarlı algılama sonrası template değiştir
+            if (template_vote_us_ >= TEMPLATE_SWITCH_US &&
+                detected_template_index_ != current_template_index_) {
+                switchTemplate(detected_template_index_);
+                template_vote_us_ = 0;
+            }
+        }
+
+        stage_timer.lap(*metric_stage_latency_[STAGE_TEMPLATE]);
+
+        // Birikimli modda sınıflandırma gürültüsü azaltılmış ortalama üzerinde, K frame'de bir
+        // veya ortalama yeniden başladığında; aradaki frame'ler son sınıflandırmayı yayınlar
+        const cv::Mat* board = &warped_normalized;
+        bool classify = true;
+        if (accumulator_config_.enabled) {
+            if (current_template_index_ != accumulated_template_ || current_rotation_ != accumulated_rotation_) {
+                accumulator_.reset();
+                accumulated_template_ = current_template_index_;
+                accumulated_rotation_ = current_rotation_;
+            }
+            bool restarted = accumulator_.add(warped_normalized);
+            if (restarted) metric_accumulator_resets_->add();
+
+            classify = restarted || ++frames_since_classify_ >= accumulator_config_.classify_interval;
+            if (classify) {
+                frames_since_classify_ = 0;
+                board = &accumulator_.average();
+            }
+            stage_timer.lap(*metric_stage_latency_[STAGE_ACCUMULATE]);
+        }
+
+        if (classify) {
+            classifyPatches(*board, timestamp_us, patch_infos_);
+            last_warp_size_ = board->size();
+            metric_classifications_->add();
+        }
+        fillBoardState(patch_infos_, result);
+        if (classify) {
+            stage_timer.lap(*metric_stage_latency_[STAGE_CLASSIFY]);
+        }
+    }
+
+    if (found) {
+        frames_without_board_ = 0;
+    }
+    else {
+        // Kaybolan tahtanın ortalaması geri geldiğinde hayalet bırakmasın; ilk frame hemen sınıflandırılır
+        accumulator_.reset();
+        frames_since_classify_ = 0;
+        if (idle_config_.enabled && ++frames_without_board_ >= idle_config_.idle_after_frames) {
+            enterIdle(timestamp_us);
+        }
+    }
+
+    metric_template_index_->set(current_template_index_);
+    metric_rotation_->set(current_rotation_);
+    accountFrame(timestamp_us, was_idle, found, frame_timer.lap(*metric_stage_latency_[STAGE_TOTAL]));
+    return found;
+}
+
+bool MosaicEngine::process(const cv::Mat& frame, PixelFormat format, int64_t timestamp_us,
+    BoardState& result) {
+    return process(makeFrameView(frame, format), timestamp_us, result);
+}
+
+bool MosaicEngine::process(const void* data, int width, int height, size_t stride,
+    PixelFormat format, int64_t timestamp_us, BoardState& result) {
+    return process(wrapFrame(data, width, height, stride, format), timestamp_us, result);
+}
+
+const cv::Mat& MosaicEngine::renderDigital() {
+    // Label haritası doğrudan döndürülmüş olarak tutulur, yazılar düz kalır
+    return renderers_[current_template_index_]->render(last_warp_size_, current_rotation_, patch_infos_);
+}
@@ -0,0 +1,98 @@
+﻿#include "PatchSampler.h"
+#include <climits>
+#include <cstdint>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+const int ERODE_ITERATIONS = 2;
+const int MASK_PADDING = 3;     // Erozyon yarıçapından (2) büyük olmalı
+
+uint32_t reverseBits(uint32_t value, int bits) {
+    uint32_t result = 0;
+    for (int i = 0; i < bits; ++i) {
+        result = (result << 1) | (value & 1u);
+        value >>= 1;
+    }
+    return result;
+}
+
+// Raster sıradaki pikselleri bit-ters indeks sırasına dizer
+std::vector<cv::Point> lowDiscrepancyOrder(const std::vector<cv::Point>& raster) {
+    std::vector<cv::Point> ordered;
+    ordered.reserve(raster.size());
+
+    int bits = 0;
+    while ((static_cast<size_t>(1) << bits) < raster.size()) ++bits;
+
+    uint32_t range = 1u << bits;
+    for (uint32_t i = 0; i < range; ++i) {
+        uint32_t index = reverseBits(i, bits);
+        if (index < raster.size()) ordered.push_back(raster[index]);
+    }
+    return ordered;
+}
+
+}
+
+PatchSampler::PatchSampler(const TemplateProcessor& template_processor)
+    : template_processor_(&template_processor) {
+}
+
+void PatchSampler::prepare(cv::Size warped_size) {
+    if (warped_size == cached_size_ && !sample_points_.empty()) return;
+    rebuild(warped_size);
+}
+
+void PatchSampler::rebuild(cv::Size warped_size) {
+    cached_size_ = warped_size;
+
+    cv::Size template_size = template_processor_->getOutputSize();
+    float scale_x = static_cast<float>(warped_size.width) / template_size.width;
+    float scale_y = static_cast<float>(warped_size.height) / template_size.height;
+
+    const auto& original_contours = template_processor_->getContours();
+    scaled_contours_.assign(original_contours.size(), std::vector<cv::Point>());
+    sample_points_.assign(original_contours.size(), std::vector<cv::Point>());
+
+    cv::Rect frame_rect(cv::Point(0, 0), warped_size);
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+
+    for (size_t i = 0; i < original_contours.size(); ++i) {
+        auto& scaled_contour = scaled_contours_[i];
+        for (const auto& pt : original_contours[i]) {
+            scaled_contour.push_back(cv::Point(
+                static_cast<int>(pt.x * scale_x),
+                static_cast<int>(pt.y * scale_y)
+            ));
+        }
+
+        // Maske tüm frame yerine patch'in (pay eklenmiş) sınır kutusunda hesaplanır.
+        // Frame kenarında kırpılan taraflarda erode'un kenar davranışı aynı kaldığı için
+        // sonuç tam boyutlu maskeyle birebir aynıdır.
+        cv::Rect bounds = cv::boundingRect(scaled_contour);
+        bounds.x -= MASK_PADDING;
+        bounds.y -= MASK_PADDING;
+        bounds.width += 2 * MASK_PADDING;
+        bounds.height += 2 * MASK_PADDING;
+        bounds &= frame_rect;
+        if (bounds.empty()) continue;
+
+        cv::Mat mask = cv::Mat::zeros(bounds.size(), CV_8U);
+        std::vector<std::vector<cv::Point>> contour_vec = { scaled_contour };
+        cv::drawContours(mask, contour_vec, 0, cv::Scalar(255), cv::FILLED,
+            cv::LINE_8, cv::noArray(), INT_MAX, -bounds.tl());
+
+        cv::Mat mask_eroded;
+        cv::erode(mask, mask_eroded, kernel, cv::Point(-1, -1), ERODE_ITERATIONS);
+
+        std::vector<cv::Point> raster;
+        for (int y = 0; y < mask_eroded.rows; ++y) {
+            const uchar* row = mask_eroded.ptr<uchar>(y);
+            for (int x = 0; x < mask_eroded.cols; ++x) {
+                if (row[x] != 0) raster.push_back(cv::Point(bounds.x + x, bounds.y + y));
+            }
+        }
+        sample_points_[i] = lowDiscrepancyOrder(raster);
+    }
+}
@@ -0,0 +1,132 @@
+#include "ResultProtocol.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    void putU16(uint8_t*& p, uint16_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p += 2;
+    }
+
+    void putU32(uint8_t*& p, uint32_t v) {
+        for (int i = 0; i < 4; i++) *p++ = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    void putU64(uint8_t*& p, uint64_t v) {
+        for (int i = 0; i < 8; i++) *p++ = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    uint16_t getU16(const uint8_t*& p) {
+        uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    }
+
+    uint32_t getU32(const uint8_t*& p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(*p++) << (8 * i);
+        return v;
+    }
+
+    uint64_t getU64(const uint8_t*& p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(*p++) << (8 * i);
+        return v;
+    }
+}
+
+uint16_t toFillPermille(float fill_ratio) {
+    float clamped = std::max(0.0f, std::min(1.0f, fill_ratio));
+    return static_cast<uint16_t>(std::lround(clamped * 1000.0f));
+}
+
+size_t encodedResultSize(const ResultMessage& message) {
+    return RESULT_HEADER_SIZE + message.updates.size() * RESULT_UPDATE_SIZE;
+}
+
+void encodeResultMessage(const ResultMessage& message, std::vector<uint8_t>& out) {
+    out.resize(encodedResultSize(message));
+    uint8_t* p = out.data();
+
+    putU32(p, RESULT_MESSAGE_MAGIC);
+    *p++ = RESULT_PROTOCOL_VERSION;
+    *p++ = static_cast<uint8_t>(message.type);
+    putU16(p, message.rotation);
+    putU64(p, message.sequence);
+    putU64(p, message.frame_index);
+    putU64(p, static_cast<uint64_t>(message.timestamp_us));
+    putU16(p, message.template_index);
+    putU16(p, message.patch_count);
+    putU16(p, static_cast<uint16_t>(message.updates.size()));
+
+    for (const auto& update : message.updates) {
+        putU16(p, update.patch_id);
+        *p++ = static_cast<uint8_t>(update.color);
+        putU16(p, update.fill_permille);
+    }
+}
+
+bool decodeResultMessage(const uint8_t* data, size_t size, ResultMessage& message) {
+    if (size < RESULT_HEADER_SIZE) return false;
+
+    const uint8_t* p = data;
+    if (getU32(p) != RESULT_MESSAGE_MAGIC) return false;
+    if (*p++ != RESULT_PROTOCOL_VERSION) return false;
+
+    uint8_t type = *p++;
+    if (type != static_cast<uint8_t>(ResultMessageType::FullSnapshot) &&
+        type != static_cast<uint8_t>(ResultMessageType::Delta) &&
+        type != static_cast<uint8_t>(ResultMessageType::BoardLost)) {
+        return false;
+    }
+    message.type = static_cast<ResultMessageType>(type);
+    message.rotation = getU16(p);
+    message.sequence = getU64(p);
+    message.frame_index = getU64(p);
+    message.timestamp_us = static_cast<int64_t>(getU64(p));
+    message.template_index = getU16(p);
+    message.patch_count = getU16(p);
+    uint16_t update_count = getU16(p);
+
+    if (size < RESULT_HEADER_SIZE + update_count * RESULT_UPDATE_SIZE) return false;
+
+    message.updates.resize(update_count);
+    for (auto& update : message.updates) {
+        update.patch_id = getU16(p);
+        uint8_t color = *p++;
+        update.color = color <= static_cast<uint8_t>(PatchColor::Unknown)
+            ? static_cast<PatchColor>(color) : PatchColor::Unknown;
+        update.fill_permille = getU16(p);
+    }
+    return true;
+}
+
+bool applyResultMessage(const ResultMessage& message, std::vector<PatchUpdate>& board,
+    int& board_template, bool& board_visible) {
+
+    if (message.type == ResultMessageType::BoardLost) {
+        board_visible = false;
+        return true;
+    }
+
+    if (message.type == ResultMessageType::FullSnapshot) {
+        board.assign(message.patch_count, PatchUpdate{ 0, PatchColor::White, 0 });
+        for (size_t i = 0; i < board.size(); ++i) {
+            board[i].patch_id = static_cast<uint16_t>(i);
+        }
+        board_template = message.template_index;
+    }
+    else if (board_template != message.template_index ||
+        board.size() != message.patch_count) {
+        return false;
+    }
+
+    for (const auto& update : message.updates) {
+        if (update.patch_id < board.size()) {
+            board[update.patch_id] = update;
+        }
+    }
+    board_visible = true;
+    return true;
+}
@@ -0,0 +1,203 @@
+﻿#include "ResultPublisher.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+ResultPublisher::ResultPublisher(const PublisherConfig& config)
+    : config_(config), server_socket_(-1), client_joined_(false), last_template_(-1),
+    board_visible_(false), sequence_(0), messages_since_snapshot_(0) {
+
+    ring_ = std::make_unique<MessageRingWriter>(config_.shm_name,
+        config_.slot_count, config_.slot_size);
+    std::cout << "Publishing results to shared memory: " << config_.shm_name << std::endl;
+
+    if (!config_.socket_path.empty()) {
+        openSocket();
+    }
+}
+
+ResultPublisher::~ResultPublisher() {
+    closeSockets();
+}
+
+void ResultPublisher::publish(const BoardState& state) {
+    acceptClients();
+
+    // Kayıpta patch gönderilmez; son yayınlanan durum delta tabanı olarak kalır.
+    // Yeni istemci bekliyorsa (client_joined_) tahta geri geldiğinde snapshot alır.
+    if (!state.board_visible) {
+        if (!board_visible_) return;
+
+        message_.updates.clear();
+        message_.type = ResultMessageType::BoardLost;
+        message_.sequence = sequence_++;
+        message_.frame_index = state.frame_index;
+        message_.timestamp_us = state.timestamp_us;
+        message_.template_index = static_cast<uint16_t>(std::max(last_template_, 0));
+        message_.patch_count = static_cast<uint16_t>(last_published_.size());
+
+        encodeResultMessage(message_, buffer_);
+        ring_->write(buffer_.data(), buffer_.size());
+        sendToClients(buffer_);
+
+        board_visible_ = false;
+        return;
+    }
+
+    bool full_snapshot = client_joined_ ||
+        last_template_ != state.template_index ||
+        last_published_.size() != state.patches.size() ||
+        messages_since_snapshot_ + 1 >= config_.full_snapshot_interval;
+
+    if (last_published_.size() != state.patches.size()) {
+        last_published_.assign(state.patches.size(), PatchUpdate{ 0, PatchColor::White, 0 });
+    }
+
+    message_.updates.clear();
+    for (size_t i = 0; i < state.patches.size(); ++i) {
+        PatchUpdate update;
+        update.patch_id = static_cast<uint16_t>(i);
+        update.color = state.patches[i].color;
+        update.fill_permille = toFillPermille(state.patches[i].fill_ratio);
+
+        PatchUpdate& previous = last_published_[i];
+        bool changed = previous.color != update.color ||
+            previous.fill_permille != update.fill_permille;
+
+        if (full_snapshot || changed) {
+            message_.updates.push_back(update);
+        }
+        previous = update;
+    }
+
+    message_.type = full_snapshot ? ResultMessageType::FullSnapshot : ResultMessageType::Delta;
+    message_.sequence = sequence_++;
+    message_.frame_index = state.frame_index;
+    message_.timestamp_us = state.timestamp_us;
+    message_.template_index = static_cast<uint16_t>(state.template_index);
+    message_.rotation = static_cast<uint16_t>(state.rotation);
+    message_.patch_count = static_cast<uint16_t>(state.patches.size());
+
+    encodeResultMessage(message_, buffer_);
+
+    if (!ring_->write(buffer_.data(), buffer_.size())) {
+        std::cerr << "Warning: result message (" << buffer_.size()
+            << " bytes) does not fit ring slot (" << ring_->slotSize() << " bytes)" << std::endl;
+    }
+    sendToClients(buffer_);
+
+    last_template_ = state.template_index;
+    board_visible_ = true;
+    messages_since_snapshot_ = full_snapshot ? 0 : messages_since_snapshot_ + 1;
+    client_joined_ = false;
+}
+
+#ifdef _WIN32
+
+void ResultPublisher::openSocket() {
+    std::cerr << "Warning: Unix socket output is not supported on this platform" << std::endl;
+}
+
+void ResultPublisher::acceptClients() {}
+void ResultPublisher::sendToClients(const std::vector<uint8_t>&) {}
+void ResultPublisher::closeSockets() {}
+
+#else
+
+void ResultPublisher::openSocket() {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (config_.socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + config_.socket_path);
+    }
+    std::strncpy(addr.sun_path, config_.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    server_socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_socket_ < 0) {
+        throw std::runtime_error("Failed to create socket: " + config_.socket_path);
+    }
+
+    unlink(config_.socket_path.c_str());
+    if (bind(server_socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(server_socket_, 8) != 0) {
+        close(server_socket_);
+        server_socket_ = -1;
+        throw std::runtime_error("Failed to listen on socket: " + config_.socket_path);
+    }
+
+    // accept() frame döngüsünü hiç bekletmemeli
+    fcntl(server_socket_, F_SETFL, fcntl(server_socket_, F_GETFL, 0) | O_NONBLOCK);
+    std::cout << "Publishing results to socket: " << config_.socket_path << std::endl;
+}
+
+void ResultPublisher::acceptClients() {
+    if (server_socket_ < 0) return;
+
+    while (true) {
+        int client = accept(server_socket_, nullptr, nullptr);
+        if (client < 0) break;
+
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        client_sockets_.push_back(client);
+        client_joined_ = true;  // Yeni istemci önce tam snapshot almalı
+    }
+}
+
+void ResultPublisher::sendToClients(const std::vector<uint8_t>& data) {
+    if (client_sockets_.empty()) return;
+
+    // Stream üzerinde mesaj sınırı: u32 uzunluk öneki
+    uint32_t length = static_cast<uint32_t>(data.size());
+    uint8_t prefix[4] = {
+        static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+        static_cast<uint8_t>(length >> 16), static_cast<uint8_t>(length >> 24)
+    };
+
+    int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+
+    for (size_t i = 0; i < client_sockets_.size();) {
+        int client = client_sockets_[i];
+        bool ok = send(client, prefix, sizeof(prefix), flags) == static_cast<ssize_t>(sizeof(prefix)) &&
+            send(client, data.data(), data.size(), flags) == static_cast<ssize_t>(data.size());
+
+        // Yetişemeyen istemciyi bekleme, bağlantısını kes
+        if (!ok) {
+            close(client);
+            client_sockets_.erase(client_sockets_.begin() + i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+void ResultPublisher::closeSockets() {
+    for (int client : client_sockets_) {
+        close(client);
+    }
+    client_sockets_.clear();
+
+    if (server_socket_ >= 0) {
+        close(server_socket_);
+        unlink(config_.socket_path.c_str());
+        server_socket_ = -1;
+    }
+}
+
+#endif
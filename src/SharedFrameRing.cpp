@@ -0,0 +1,195 @@
+﻿#include "SharedFrameRing.h"
+#include <new>
+#include <stdexcept>
+
+namespace {
+    const uint32_t FRAME_RING_MAGIC = 0x474E5246;  // "FRNG"
+    const uint32_t FRAME_RING_VERSION = 1;
+    const uint32_t NO_SLOT = 0xFFFFFFFF;
+    const size_t PAGE_SIZE_BYTES = 4096;
+
+    size_t pageAlign(size_t size) {
+        return (size + PAGE_SIZE_BYTES - 1) & ~(PAGE_SIZE_BYTES - 1);
+    }
+
+    size_t metadataSize(size_t slot_count) {
+        return pageAlign(sizeof(SharedFrameRingHeader) + slot_count * sizeof(SharedFrameSlot));
+    }
+}
+
+// ===================== ÜRETİCİ =====================
+
+SharedFrameWriter::SharedFrameWriter(const std::string& name, size_t slot_count, size_t slot_capacity)
+    : next_sequence_(0), next_slot_(0), current_slot_(NO_SLOT), claimed_skips_(0) {
+    // Okuyucu bir slot'u tutarken üreticinin yazabileceği en az bir slot kalmalı
+    if (slot_count < 2 || slot_capacity == 0) {
+        throw std::runtime_error("Frame ring needs at least two non-empty slots!");
+    }
+
+    data_stride_ = pageAlign(slot_capacity);
+    size_t metadata = metadataSize(slot_count);
+    region_ = SharedMemoryRegion::create(name, metadata + slot_count * data_stride_);
+
+    uint8_t* base = static_cast<uint8_t*>(region_->data());
+    header_ = new (base) SharedFrameRingHeader();
+    slots_ = reinterpret_cast<SharedFrameSlot*>(base + sizeof(SharedFrameRingHeader));
+    data_ = base + metadata;
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        SharedFrameSlot* slot = new (&slots_[i]) SharedFrameSlot();
+        slot->state.store(0, std::memory_order_relaxed);
+    }
+
+    header_->slot_count = static_cast<uint32_t>(slot_count);
+    header_->slot_capacity = data_stride_;
+    header_->version = FRAME_RING_VERSION;
+    header_->write_sequence.store(0, std::memory_order_relaxed);
+    header_->latest_slot.store(NO_SLOT, std::memory_order_relaxed);
+    header_->reader_slot.store(NO_SLOT, std::memory_order_relaxed);
+    header_->closed.store(0, std::memory_order_relaxed);
+
+    // Magic en son yazılır - okuyucular yarım başlatılmış halkaya bağlanmaz
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = FRAME_RING_MAGIC;
+}
+
+SharedFrameWriter::~SharedFrameWriter() {
+    close();
+}
+
+cv::Mat SharedFrameWriter::beginFrame(int rows, int cols, int mat_type) {
+    size_t step = static_cast<size_t>(cols) * CV_ELEM_SIZE(mat_type);
+    if (rows <= 0 || cols <= 0 || step * rows > header_->slot_capacity) {
+        return cv::Mat();
+    }
+
+    uint64_t seq = next_sequence_;
+    uint32_t count = header_->slot_count;
+
+    for (uint32_t attempt = 0; attempt < count; ++attempt) {
+        uint32_t index = (next_slot_ + attempt) % count;
+        SharedFrameSlot& slot = slots_[index];
+
+        // Slot'u "yazılıyor" işaretle, sonra okuyucunun sahiplenip sahiplenmediğine bak.
+        // Okuyucu tersini yapar (sahiplen, sonra durumu doğrula); ikisi de seq_cst olduğundan
+        // en az biri diğerini görür ve aynı slot'u iki taraf birden kullanamaz.
+        uint64_t previous = slot.state.load(std::memory_order_relaxed);
+        slot.state.store(2 * seq + 1, std::memory_order_seq_cst);
+        if (header_->reader_slot.load(std::memory_order_seq_cst) == index) {
+            slot.state.store(previous, std::memory_order_seq_cst);
+            claimed_skips_++;
+            continue;
+        }
+
+        slot.rows = static_cast<uint32_t>(rows);
+        slot.cols = static_cast<uint32_t>(cols);
+        slot.mat_type = static_cast<uint32_t>(mat_type);
+        slot.step = step;
+        current_slot_ = index;
+        next_slot_ = (index + 1) % count;
+        return cv::Mat(rows, cols, mat_type, data_ + index * data_stride_, step);
+    }
+
+    // slot_count >= 2 ve okuyucu en fazla bir slot tuttuğundan buraya gelinmez
+    throw std::runtime_error("No free frame slot!");
+}
+
+void SharedFrameWriter::publish(PixelFormat format, int64_t timestamp_us) {
+    if (current_slot_ == NO_SLOT) {
+        throw std::runtime_error("publish() without beginFrame()!");
+    }
+
+    uint64_t seq = next_sequence_;
+    SharedFrameSlot& slot = slots_[current_slot_];
+    slot.format = static_cast<uint32_t>(format);
+    slot.timestamp_us = timestamp_us;
+    slot.state.store(2 * seq + 2, std::memory_order_release);
+
+    header_->latest_slot.store(current_slot_, std::memory_order_release);
+    header_->write_sequence.store(seq + 1, std::memory_order_release);
+
+    current_slot_ = NO_SLOT;
+    next_sequence_ = seq + 1;
+}
+
+bool SharedFrameWriter::write(const FrameView& frame, int64_t timestamp_us) {
+    cv::Mat slot = beginFrame(frame.data.rows, frame.data.cols, frame.data.type());
+    if (slot.empty()) return false;
+
+    frame.data.copyTo(slot);
+    publish(frame.format, timestamp_us);
+    return true;
+}
+
+void SharedFrameWriter::close() {
+    if (header_ != nullptr) {
+        header_->closed.store(1, std::memory_order_release);
+    }
+}
+
+// ===================== OKUYUCU =====================
+
+SharedFrameReader::SharedFrameReader(const std::string& name)
+    : dropped_(0) {
+    region_ = SharedMemoryRegion::open(name);
+
+    uint8_t* base = static_cast<uint8_t*>(region_->data());
+    header_ = reinterpret_cast<SharedFrameRingHeader*>(base);
+    if (region_->size() < sizeof(SharedFrameRingHeader) || header_->magic != FRAME_RING_MAGIC ||
+        header_->version != FRAME_RING_VERSION) {
+        throw std::runtime_error("Not a frame ring: " + name);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    size_t metadata = metadataSize(header_->slot_count);
+    data_stride_ = static_cast<size_t>(header_->slot_capacity);
+    if (region_->size() < metadata + header_->slot_count * data_stride_) {
+        throw std::runtime_error("Truncated frame ring: " + name);
+    }
+
+    slots_ = reinterpret_cast<const SharedFrameSlot*>(base + sizeof(SharedFrameRingHeader));
+    data_ = base + metadata;
+
+    // Bağlanmadan önce yayınlanmış son frame de okunabilir
+    uint64_t written = header_->write_sequence.load(std::memory_order_acquire);
+    next_sequence_ = written > 0 ? written - 1 : 0;
+}
+
+SharedFrameReader::~SharedFrameReader() {
+    release();
+}
+
+FrameReadResult SharedFrameReader::acquire(FrameView& frame, int64_t& timestamp_us) {
+    while (true) {
+        uint64_t written = header_->write_sequence.load(std::memory_order_acquire);
+        if (written <= next_sequence_) {
+            return header_->closed.load(std::memory_order_acquire) != 0
+                ? FrameReadResult::Closed : FrameReadResult::Empty;
+        }
+
+        uint64_t seq = written - 1;
+        uint32_t index = header_->latest_slot.load(std::memory_order_acquire);
+        if (index >= header_->slot_count) continue;
+
+        // Slot'u sahiplen ve hâlâ bu frame'i taşıdığını doğrula; üretici araya girdiyse
+        // (slot yeniden yazılıyor veya daha yeni frame yayınlandı) baştan dene
+        header_->reader_slot.store(index, std::memory_order_seq_cst);
+        const SharedFrameSlot& slot = slots_[index];
+        if (slot.state.load(std::memory_order_seq_cst) != 2 * seq + 2) continue;
+
+        cv::Mat data(static_cast<int>(slot.rows), static_cast<int>(slot.cols),
+            static_cast<int>(slot.mat_type), data_ + index * data_stride_, static_cast<size_t>(slot.step));
+        frame = makeFrameView(data, static_cast<PixelFormat>(slot.format));
+        timestamp_us = slot.timestamp_us;
+
+        dropped_ += seq - next_sequence_;
+        next_sequence_ = seq + 1;
+        return FrameReadResult::Frame;
+    }
+}
+
+void SharedFrameReader::release() {
+    if (header_ != nullptr) {
+        header_->reader_slot.store(NO_SLOT, std::memory_order_seq_cst);
+    }
+}
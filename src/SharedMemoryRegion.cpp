@@ -0,0 +1,145 @@
+﻿#include "SharedMemoryRegion.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+    std::string systemName(const std::string& name) {
+        return "Local\\" + name;
+    }
+#else
+    std::string systemName(const std::string& name) {
+        return name.empty() || name[0] != '/' ? "/" + name : name;
+    }
+#endif
+}
+
+SharedMemoryRegion::SharedMemoryRegion()
+    : data_(nullptr), size_(0), owner_(false)
+#ifdef _WIN32
+    , handle_(nullptr)
+#endif
+{
+}
+
+#ifdef _WIN32
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::create(const std::string& name, size_t size) {
+    std::unique_ptr<SharedMemoryRegion> region(new SharedMemoryRegion());
+    region->name_ = systemName(name);
+    region->owner_ = true;
+
+    unsigned long long size64 = size;
+    region->handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF),
+        region->name_.c_str());
+    if (region->handle_ == nullptr) {
+        throw std::runtime_error("Failed to create shared memory: " + name);
+    }
+
+    region->data_ = MapViewOfFile(region->handle_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (region->data_ == nullptr) {
+        throw std::runtime_error("Failed to map shared memory: " + name);
+    }
+    region->size_ = size;
+    return region;
+}
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::open(const std::string& name) {
+    std::unique_ptr<SharedMemoryRegion> region(new SharedMemoryRegion());
+    region->name_ = systemName(name);
+
+    region->handle_ = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, region->name_.c_str());
+    if (region->handle_ == nullptr) {
+        throw std::runtime_error("Failed to open shared memory: " + name);
+    }
+
+    region->data_ = MapViewOfFile(region->handle_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (region->data_ == nullptr) {
+        throw std::runtime_error("Failed to map shared memory: " + name);
+    }
+
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(region->data_, &info, sizeof(info));
+    region->size_ = info.RegionSize;
+    return region;
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (handle_ != nullptr) CloseHandle(handle_);
+}
+
+#else
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::create(const std::string& name, size_t size) {
+    std::unique_ptr<SharedMemoryRegion> region(new SharedMemoryRegion());
+    region->name_ = systemName(name);
+
+    // Önceki bir çalışmadan kalan bölgeyi temizle
+    shm_unlink(region->name_.c_str());
+
+    int fd = shm_open(region->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory: " + name);
+    }
+    region->owner_ = true;
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to resize shared memory: " + name);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory: " + name);
+    }
+    region->data_ = data;
+    region->size_ = size;
+    return region;
+}
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::open(const std::string& name) {
+    std::unique_ptr<SharedMemoryRegion> region(new SharedMemoryRegion());
+    region->name_ = systemName(name);
+
+    int fd = shm_open(region->name_.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open shared memory: " + name);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Invalid shared memory size: " + name);
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory: " + name);
+    }
+    region->data_ = data;
+    region->size_ = static_cast<size_t>(st.st_size);
+    return region;
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (data_ != nullptr) munmap(data_, size_);
+    if (owner_) shm_unlink(name_.c_str());
+}
+
+#endif
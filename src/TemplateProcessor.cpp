@@ -1,6 +1,8 @@
 #include "TemplateProcessor.h"
 #include <stdexcept>
 #include <iostream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
 
 TemplateProcessor::TemplateProcessor(const std::string& template_path) {
     template_image_ = cv::imread(template_path);
@@ -1,8 +1,131 @@
 #include "MosaicDetector.h"
+#include "BatchProcessor.h"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
-int main() {
+// Kayd / videoyu tm ekirdeklerde iler; --verify ile sral almayla karlatrr
+static int runBatch(const std::string& input_path, const std::string& output_path,
+    const std::vector<std::string>& template_paths, const std::vector<std::string>& template_names,
+    int marker_id, const BatchConfig& config, bool verify) {
+
+    BatchProcessor processor(template_paths, template_names, marker_id, config);
+    BatchResult result = processor.process(input_path);
+
+    std::cout << "Batch: " << result.states.size() << " frames, " << result.segments << " segments, "
+        << result.fixed_up_frames << " re-processed, " << result.seconds << " s ("
+        << (result.seconds > 0 ? result.states.size() / result.seconds : 0.0) << " fps)" << std::endl;
+    if (result.unseekable_segments > 0) {
+        std::cout << "  " << result.unseekable_segments << " segments decoded from the start (inaccurate seek)" << std::endl;
+    }
+
+    if (!output_path.empty()) {
+        std::ofstream out(output_path);
+        writeBatchResults(result.states, out);
+    }
+
+    if (!verify) return 0;
+
+    BatchResult sequential = processor.processSequential(input_path);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < result.states.size() || i < sequential.states.size(); ++i) {
+        bool same = i < result.states.size() && i < sequential.states.size() &&
+            sameBoardState(result.states[i], sequential.states[i]);
+        if (!same && ++mismatches <= 10) {
+            std::cerr << "Mismatch at frame " << i << std::endl;
+        }
+    }
+
+    std::cout << "Sequential: " << sequential.seconds << " s, speedup "
+        << (result.seconds > 0 ? sequential.seconds / result.seconds : 0.0)
+        << "x, mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Kullanm:
+//   MosaicCMake                              Kameradan canl alglama
+//   MosaicCMake --record FILE [--png]        Canl alglama + frame/sonu kayd
+//   MosaicCMake --native                     Kamerann YUYV/NV12 formatn dntrmeden kullan
+//   MosaicCMake --mjpeg [SCALE]              MJPEG al, marker'lar 1/SCALE decode'da ara (varsaylan 2)
+//   MosaicCMake --shm-frames NAME            Frame'leri baka srecin paylaml bellek halkasndan al
+//   MosaicCMake --replay FILE [--fast]       Kayd tekrar oynat ve sonular karlatr
+//   MosaicCMake --batch FILE [--workers N] [--batch-out CSV] [--verify]
+//                                            Kayd (.mrec) veya videoyu paralel ile
+//   MosaicCMake ... --template-markers 23,24 Template'i marker ID'sinden al (i. ID -> i. template)
+//   MosaicCMake ... --metrics-port PORT      Metrikleri http://127.0.0.1:PORT/metrics adresinde sun
+//   MosaicCMake ... --metrics-json FILE      Metrikleri her saniye JSON dosyasna yaz
+//   MosaicCMake ... --accumulate K           Tahtann zamansal ortalamasn K frame'de bir snflandr
+//   MosaicCMake ... --accumulate-decay S     stel ortalamada yeni frame arl 1/2^S (varsaylan 2)
+//   MosaicCMake ... --accumulate-box N       stel yerine son N frame'in dz ortalamas
+//   MosaicCMake ... --calibration FILE       Lens bozulmasn dzelt (CameraCalibrate kts)
+//   MosaicCMake ... --idle                   Tahta uzun sre grnmezse dk gl taramaya ge
+//   MosaicCMake ... --exact                  rnekleme yerine her pikseli say
+//   MosaicCMake ... --fill-error E           rneklemede doluluk hatas (varsaylan 0.02)
+int main(int argc, char** argv) {
+    std::string record_path;
+    std::string replay_path;
+    std::string shm_frames_name;
+    bool lossless_compression = false;
+    bool replay_fast = false;
+    CaptureConfig capture_config;
+    std::vector<int> template_marker_ids;
+    SamplingConfig sampling_config;
+    std::string batch_path;
+    std::string batch_output_path;
+    bool batch_verify = false;
+    int batch_workers = 0;
+    MetricsConfig metrics_config;
+    IdleConfig idle_config;
+    std::string calibration_path;
+    AccumulatorConfig accumulator_config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) record_path = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replay_path = argv[++i];
+        else if (arg == "--shm-frames" && i + 1 < argc) shm_frames_name = argv[++i];
+        else if (arg == "--png") lossless_compression = true;
+        else if (arg == "--fast") replay_fast = true;
+        else if (arg == "--native") capture_config.format = CaptureFormat::Native;
+        else if (arg == "--mjpeg") {
+            capture_config.format = CaptureFormat::MJPEG;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                capture_config.mjpeg_detection_scale = std::stoi(argv[++i]);
+            }
+        }
+        else if (arg == "--batch" && i + 1 < argc) batch_path = argv[++i];
+        else if (arg == "--batch-out" && i + 1 < argc) batch_output_path = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) batch_workers = std::stoi(argv[++i]);
+        else if (arg == "--verify") batch_verify = true;
+        else if (arg == "--template-markers" && i + 1 < argc) {
+            std::stringstream ids(argv[++i]);
+            std::string id;
+            while (std::getline(ids, id, ',')) template_marker_ids.push_back(std::stoi(id));
+        }
+        else if (arg == "--metrics-port" && i + 1 < argc) metrics_config.http_port = std::stoi(argv[++i]);
+        else if (arg == "--metrics-json" && i + 1 < argc) metrics_config.json_path = argv[++i];
+        else if (arg == "--accumulate" && i + 1 < argc) {
+            accumulator_config.enabled = true;
+            accumulator_config.classify_interval = std::stoi(argv[++i]);
+        }
+        else if (arg == "--accumulate-decay" && i + 1 < argc) accumulator_config.decay_shift = std::stoi(argv[++i]);
+        else if (arg == "--accumulate-box" && i + 1 < argc) {
+            accumulator_config.box = true;
+            accumulator_config.box_frames = std::stoi(argv[++i]);
+        }
+        else if (arg == "--calibration" && i + 1 < argc) calibration_path = argv[++i];
+        else if (arg == "--idle") idle_config.enabled = true;
+        else if (arg == "--exact") sampling_config.enabled = false;
+        else if (arg == "--fill-error" && i + 1 < argc) sampling_config.fill_error = std::stof(argv[++i]);
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return -1;
+        }
+    }
+
     try {
         // Template dosya yollar
         std::vector<std::string> template_paths = {
@@ -17,12 +140,60 @@ int main() {
         };
 
         int marker_id = 23;
-        int camera_index = 0;
+
+        CameraCalibration calibration;
+        if (!calibration_path.empty()) {
+            calibration = CameraCalibration::load(calibration_path);
+            std::cout << "Calibration loaded: " << calibration_path << " (" << calibration.imageSize().width
+                << "x" << calibration.imageSize().height << ")" << std::endl;
+        }
+
+        if (!batch_path.empty()) {
+            if (idle_config.enabled || accumulator_config.enabled) {
+                throw std::runtime_error("--batch cannot be combined with --idle or --accumulate "
+                    "(their state does not carry across segments)");
+            }
+            BatchConfig batch_config;
+            batch_config.workers = batch_workers;
+            batch_config.sampling = sampling_config;
+            batch_config.template_marker_ids = template_marker_ids;
+            batch_config.calibration = calibration;
+            batch_config.mjpeg_detection_scale = capture_config.mjpeg_detection_scale;
+            return runBatch(batch_path, batch_output_path, template_paths, template_names,
+                marker_id, batch_config, batch_verify);
+        }
+
+        int camera_index = replay_path.empty() && shm_frames_name.empty() ? 0 : -1;
+
+        // Sonular paylaml bellee yaynlanr (socket_path doluysa Unix socket'e de)
+        PublisherConfig publisher_config;
+        publisher_config.shm_name = "mosaic_results";
+        publisher_config.socket_path = "";
 
         std::cout << "=== Mosaic Detection System ===" << std::endl;
         std::cout << "Loading templates..." << std::endl;
 
         MosaicDetector detector(template_paths, template_names, marker_id, camera_index);
+        detector.enableResultPublishing(publisher_config);
+        detector.setSamplingConfig(sampling_config);
+        detector.configureCapture(capture_config);
+        detector.setTemplateMarkerIds(template_marker_ids);
+        detector.setIdleConfig(idle_config);
+        detector.setCalibration(calibration);
+        detector.setAccumulatorConfig(accumulator_config);
+        if (metrics_config.http_port > 0 || !metrics_config.json_path.empty()) {
+            detector.enableMetrics(metrics_config);
+        }
+
+        if (!replay_path.empty()) {
+            return detector.runReplay(replay_path, !replay_fast) ? 0 : 1;
+        }
+        if (!shm_frames_name.empty()) {
+            detector.setFrameSource(std::make_unique<SharedMemoryFrameSource>(shm_frames_name));
+        }
+        if (!record_path.empty()) {
+            detector.enableRecording(record_path, lossless_compression);
+        }
         detector.run();
     }
     catch (const std::exception& e) {
@@ -0,0 +1,90 @@
+﻿#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "MosaicEngine.h"
+#include "SyntheticBoard.h"
+
+// Tek frame'lik renk titremesi yayınlanan patch sınıfını değiştirmemeli: sınıf
+// ColorHistory'nin kararlı renginden gelir, o frame'in ham tespitinden değil.
+// Kullanım: StableColorTest <template.jpg>
+
+namespace {
+
+const int TARGET_MARKER_ID = 23;
+const int64_t FRAME_INTERVAL_US = 33333;
+const int STEADY_FRAMES = 15;
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: StableColorTest <template.jpg>" << std::endl;
+        return 2;
+    }
+    std::string template_path = argv[1];
+
+    // Boş patch yok: her patch hem kararlı hem titreyen frame'de renkli
+    SyntheticBoardConfig config;
+    config.marker_id = TARGET_MARKER_ID;
+    config.white_probability = 0.0;
+    SyntheticBoard steady(template_path, 0, config);
+    SyntheticBoard flicker(template_path, 0, config);
+
+    cv::RNG rng(7);
+    steady.randomize(rng);
+    flicker.randomize(rng);
+
+    MosaicEngine engine({ template_path }, { "Template" }, TARGET_MARKER_ID);
+    // Her frame kendi görüntüsüyle sınıflandırılır (zamansal ortalama titremeyi gizlemesin)
+    AccumulatorConfig accumulator;
+    accumulator.enabled = false;
+    engine.setAccumulatorConfig(accumulator);
+
+    BoardState before;
+    int64_t timestamp_us = 0;
+    for (int i = 0; i < STEADY_FRAMES; ++i, timestamp_us += FRAME_INTERVAL_US) {
+        engine.process(steady.renderFrame(0, rng), PixelFormat::BGR, timestamp_us, before);
+    }
+    if (!before.board_visible) {
+        std::cerr << "FAIL: board not found in steady frames" << std::endl;
+        return 1;
+    }
+
+    BoardState after;
+    if (!engine.process(flicker.renderFrame(0, rng), PixelFormat::BGR, timestamp_us, after)) {
+        std::cerr << "FAIL: board not found in flicker frame" << std::endl;
+        return 1;
+    }
+
+    // Sadece titreyen frame'de gerçekten başka renge boyanan patch'ler kontrol edilir
+    BoardState flicker_expected = flicker.expectedState(0);
+    size_t checked = 0;
+    size_t changed = 0;
+    for (size_t i = 0; i < before.patches.size() && i < after.patches.size() &&
+        i < flicker_expected.patches.size(); ++i) {
+        PatchColor stable = before.patches[i].color;
+        PatchColor flickered = flicker_expected.patches[i].color;
+        if (stable == PatchColor::White || flickered == PatchColor::White || flickered == stable) continue;
+
+        checked++;
+        if (after.patches[i].color != stable) {
+            changed++;
+            std::cerr << "patch " << i << ": " << patchColorName(stable) << " -> "
+                << patchColorName(after.patches[i].color) << std::endl;
+        }
+    }
+
+    if (checked == 0) {
+        std::cerr << "FAIL: no patch changed colour in the flicker frame" << std::endl;
+        return 1;
+    }
+    if (changed > 0) {
+        std::cerr << "FAIL: " << changed << " / " << checked
+            << " patches changed class after one flicker frame" << std::endl;
+        return 1;
+    }
+
+    std::cout << "OK: " << checked << " flickering patches kept their published class" << std::endl;
+    return 0;
+}
@@ -0,0 +1,217 @@
+﻿// Kaydedilmiş satranç tahtası / ChArUco frame'lerinden kamera iç parametrelerini ve lens
+// bozulmasını hesaplar; çıktı MosaicCMake --calibration ile kullanılır.
+//
+//   CameraCalibrate (--recording FILE.mrec | --video FILE) --out calibration.yml
+//                   (--chessboard 9x6 | --charuco 7x5 --marker-size M) --square S
+//                   [--dictionary 4x4_50|5x5_250|...] [--step N] [--max-views N]
+//       --chessboard: iç köşe sayısı (sütun x satır); --charuco: kare sayısı.
+//       --square / --marker-size: kare ve marker kenarı (birim serbest, ör. mm).
+//       Frame'ler --step aralıkla denenir; birbirine çok benzeyen görüntüler atlanır.
+//
+//   Tahta görüntünün kenarlarına ve köşelerine de götürülmeli: bozulma en çok oralarda.
+#include "CameraCalibration.h"
+#include "FrameSource.h"
+#include "FrameView.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/charuco_detector.hpp>
+
+namespace {
+
+// Kabul edilen iki görüntü arasında köşelerin en az ortalama yer değiştirmesi (piksel)
+const double MIN_VIEW_MOTION_PX = 20.0;
+
+// ChArUco görüntüsünde kalibrasyona katılmak için gereken en az köşe
+const size_t MIN_CHARUCO_CORNERS = 6;
+
+// Bu değerin üstündeki yeniden izdüşüm hatası kötü kalibrasyona işaret eder (piksel)
+const double RMS_WARNING_PX = 1.0;
+
+void printUsage() {
+    std::cerr << "Usage: CameraCalibrate (--recording FILE.mrec | --video FILE) --out calibration.yml\n"
+        << "                       (--chessboard 9x6 | --charuco 7x5 --marker-size M) --square S\n"
+        << "                       [--dictionary 5x5_250] [--step N] [--max-views N]"
+        << std::endl;
+}
+
+bool parseSize(const std::string& text, cv::Size& size) {
+    size_t x = text.find('x');
+    if (x == std::string::npos) return false;
+    size = cv::Size(std::atoi(text.substr(0, x).c_str()), std::atoi(text.substr(x + 1).c_str()));
+    return size.width > 1 && size.height > 1;
+}
+
+cv::aruco::Dictionary dictionaryByName(const std::string& name) {
+    static const std::map<std::string, int> dictionaries = {
+        { "4x4_50", cv::aruco::DICT_4X4_50 }, { "4x4_100", cv::aruco::DICT_4X4_100 },
+        { "5x5_100", cv::aruco::DICT_5X5_100 }, { "5x5_250", cv::aruco::DICT_5X5_250 },
+        { "6x6_250", cv::aruco::DICT_6X6_250 }
+    };
+    auto it = dictionaries.find(name);
+    if (it == dictionaries.end()) {
+        throw std::runtime_error("Unknown dictionary: " + name);
+    }
+    return cv::aruco::getPredefinedDictionary(it->second);
+}
+
+// Aynı sayıda köşeli bir önceki görüntüye göre ortalama köşe hareketi
+double meanMotion(const std::vector<cv::Point2f>& a, const std::vector<cv::Point2f>& b) {
+    if (a.size() != b.size() || a.empty()) return 1e9;
+    double total = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) total += cv::norm(a[i] - b[i]);
+    return total / a.size();
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string recording_path;
+    std::string video_path;
+    std::string output_path;
+    std::string dictionary_name = "5x5_250";
+    cv::Size chessboard, charuco;
+    double square = 0.0;
+    double marker_size = 0.0;
+    int step = 5;
+    size_t max_views = 40;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--recording" && i + 1 < argc) recording_path = argv[++i];
+        else if (arg == "--video" && i + 1 < argc) video_path = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) output_path = argv[++i];
+        else if (arg == "--chessboard" && i + 1 < argc && parseSize(argv[i + 1], chessboard)) ++i;
+        else if (arg == "--charuco" && i + 1 < argc && parseSize(argv[i + 1], charuco)) ++i;
+        else if (arg == "--square" && i + 1 < argc) square = std::atof(argv[++i]);
+        else if (arg == "--marker-size" && i + 1 < argc) marker_size = std::atof(argv[++i]);
+        else if (arg == "--dictionary" && i + 1 < argc) dictionary_name = argv[++i];
+        else if (arg == "--step" && i + 1 < argc) step = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-views" && i + 1 < argc) max_views = static_cast<size_t>(std::max(3, std::atoi(argv[++i])));
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    bool use_charuco = charuco.area() > 0;
+    if ((recording_path.empty() == video_path.empty()) || output_path.empty() || square <= 0.0 ||
+        (chessboard.area() > 0) == use_charuco || (use_charuco && marker_size <= 0.0)) {
+        printUsage();
+        return -1;
+    }
+
+    try {
+        std::unique_ptr<FrameSource> source;
+        if (!recording_path.empty()) source = std::make_unique<ReplaySource>(recording_path, false);
+        else source = std::make_unique<VideoCaptureSource>(video_path);
+
+        std::unique_ptr<cv::aruco::CharucoBoard> board;
+        std::unique_ptr<cv::aruco::CharucoDetector> charuco_detector;
+        if (use_charuco) {
+            board = std::make_unique<cv::aruco::CharucoBoard>(charuco, static_cast<float>(square),
+                static_cast<float>(marker_size), dictionaryByName(dictionary_name));
+            charuco_detector = std::make_unique<cv::aruco::CharucoDetector>(*board);
+        }
+
+        std::vector<cv::Point3f> chessboard_points;
+        for (int y = 0; y < chessboard.height; ++y) {
+            for (int x = 0; x < chessboard.width; ++x) {
+                chessboard_points.push_back(cv::Point3f(static_cast<float>(x * square), static_cast<float>(y * square), 0.0f));
+            }
+        }
+
+        std::vector<std::vector<cv::Point3f>> object_views;
+        std::vector<std::vector<cv::Point2f>> image_views;
+        cv::Size image_size;
+        FrameView frame;
+        int64_t timestamp_us = 0;
+        cv::Mat bgr, gray;
+        long index = 0, tried = 0;
+
+        while (object_views.size() < max_views && source->read(frame, timestamp_us)) {
+            if (index++ % step != 0) continue;
+            tried++;
+
+            convertToBGR(frame, bgr);
+            cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+            if (image_size.area() == 0) image_size = gray.size();
+            if (gray.size() != image_size) {
+                throw std::runtime_error("Frame size changed during the recording!");
+            }
+
+            std::vector<cv::Point3f> object_points;
+            std::vector<cv::Point2f> image_points;
+            if (use_charuco) {
+                std::vector<cv::Point2f> charuco_corners;
+                std::vector<int> charuco_ids;
+                charuco_detector->detectBoard(gray, charuco_corners, charuco_ids);
+                if (charuco_corners.size() < MIN_CHARUCO_CORNERS) continue;
+                board->matchImagePoints(charuco_corners, charuco_ids, object_points, image_points);
+            }
+            else {
+                if (!cv::findChessboardCorners(gray, chessboard, image_points,
+                    cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK)) continue;
+                cv::cornerSubPix(gray, image_points, cv::Size(11, 11), cv::Size(-1, -1),
+                    cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01));
+                object_points = chessboard_points;
+            }
+
+            // Aynı pozun tekrarları çözümü o poza doğru çeker
+            if (!image_views.empty() && meanMotion(image_points, image_views.back()) < MIN_VIEW_MOTION_PX) continue;
+
+            object_views.push_back(object_points);
+            image_views.push_back(image_points);
+            std::cout << "View " << object_views.size() << ": frame " << (index - 1) << ", "
+                << image_points.size() << " corners" << std::endl;
+        }
+
+        std::cout << "Frames tried: " << tried << ", views used: " << object_views.size() << std::endl;
+        if (object_views.size() < 3) {
+            throw std::runtime_error("Not enough calibration views (at least 3 needed)!");
+        }
+
+        cv::Mat camera_matrix, dist_coeffs;
+        std::vector<cv::Mat> rvecs, tvecs;
+        double rms = cv::calibrateCamera(object_views, image_views, image_size,
+            camera_matrix, dist_coeffs, rvecs, tvecs);
+
+        CameraCalibration calibration(camera_matrix, dist_coeffs, image_size);
+        calibration.save(output_path, rms);
+
+        // Bozulmanın büyüklüğü: görüntü köşelerinin düzeltmeyle yer değiştirmesi
+        std::vector<cv::Point2f> corners = {
+            cv::Point2f(0, 0), cv::Point2f(static_cast<float>(image_size.width - 1), 0),
+            cv::Point2f(0, static_cast<float>(image_size.height - 1)),
+            cv::Point2f(static_cast<float>(image_size.width - 1), static_cast<float>(image_size.height - 1))
+        };
+        std::vector<cv::Point2f> undistorted = corners;
+        calibration.undistortPoints(undistorted);
+        double max_shift = 0.0;
+        for (size_t i = 0; i < corners.size(); ++i) {
+            max_shift = std::max(max_shift, static_cast<double>(cv::norm(undistorted[i] - corners[i])));
+        }
+
+        std::cout << "RMS reprojection error: " << rms << " px" << std::endl;
+        std::cout << "Image corner shift by undistortion: " << max_shift << " px" << std::endl;
+        std::cout << "Calibration written: " << output_path << " (" << image_size.width << "x"
+            << image_size.height << ")" << std::endl;
+        if (rms > RMS_WARNING_PX) {
+            std::cerr << "Warning: high reprojection error; use sharper frames covering the image edges" << std::endl;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
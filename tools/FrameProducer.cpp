@@ -0,0 +1,163 @@
+﻿// Paylaşımlı bellek frame halkası için üretici; kameraları yöneten harici sürecin yerine geçer.
+//
+//   FrameProducer [--shm NAME] [--fps F] [--frames N] [--slots K] [--nv12]
+//                 [--recording FILE.mrec | --video FILE | --camera N | --templates A.jpg B.jpg ...]
+//                 [--template-markers 23,24]
+//       Varsayılan kaynak: mosaic.jpg / mosaic_2.jpg'den sentetik tahta frame'leri.
+//       --template-markers: i. template'in tahtası i. ID'li marker'larla çizilir (varsayılan hepsi 23).
+//       Kayıttaki frame'ler piksel formatlarıyla (BGR / NV12 / YUYV / MJPEG) yazılır.
+//       --fps 0: olabildiğince hızlı; --frames 0: kaynak bitene kadar (sentetikte sonsuz).
+//
+//   Tüketici: MosaicCMake --shm-frames NAME
+#include "FrameSource.h"
+#include "FrameView.h"
+#include "SharedFrameRing.h"
+#include "SyntheticBoard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int SYNTHETIC_FRAMES_PER_BOARD = 60;
+
+// Template'ler arasında dönen, her tahtada rotasyonu değişen sentetik kamera
+class SyntheticSource : public FrameSource {
+private:
+    std::vector<std::unique_ptr<SyntheticBoard>> boards_;
+    cv::RNG rng_;
+    bool nv12_;
+    long index_ = 0;
+    cv::Mat frame_;
+
+public:
+    SyntheticSource(const std::vector<std::string>& template_paths,
+        const std::vector<int>& marker_ids, bool nv12)
+        : rng_(12345), nv12_(nv12) {
+        SyntheticBoardConfig config;
+        for (size_t i = 0; i < template_paths.size(); ++i) {
+            if (i < marker_ids.size()) config.marker_id = marker_ids[i];
+            boards_.push_back(std::make_unique<SyntheticBoard>(template_paths[i], static_cast<int>(i), config));
+        }
+    }
+
+    bool read(FrameView& frame, int64_t& timestamp_us) override {
+        long scene = index_ / SYNTHETIC_FRAMES_PER_BOARD;
+        SyntheticBoard& board = *boards_[scene % boards_.size()];
+        if (index_ % SYNTHETIC_FRAMES_PER_BOARD == 0) board.randomize(rng_);
+        index_++;
+
+        int rotation = static_cast<int>((scene / boards_.size()) % 4) * 90;
+        cv::Mat bgr = board.renderFrame(rotation, rng_);
+        frame_ = nv12_ ? convertToNV12(bgr) : bgr;
+        frame = makeFrameView(frame_, nv12_ ? PixelFormat::NV12 : PixelFormat::BGR);
+        timestamp_us = steadyTimestampUs();
+        return true;
+    }
+};
+
+void printUsage() {
+    std::cerr << "Usage: FrameProducer [--shm NAME] [--fps F] [--frames N] [--slots K] [--nv12]\n"
+        << "                     [--recording FILE.mrec | --video FILE | --camera N | --templates A.jpg ...]\n"
+        << "                     [--template-markers 23,24]"
+        << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string shm_name = "mosaic_frames";
+    std::string recording_path;
+    std::string video_path;
+    int camera_index = -1;
+    std::vector<std::string> template_paths = { "mosaic.jpg", "mosaic_2.jpg" };
+    std::vector<int> template_marker_ids;
+    double fps = 30.0;
+    long max_frames = 0;
+    int slots = 4;
+    bool nv12 = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) shm_name = argv[++i];
+        else if (arg == "--fps" && i + 1 < argc) fps = std::atof(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc) max_frames = std::atol(argv[++i]);
+        else if (arg == "--slots" && i + 1 < argc) slots = std::atoi(argv[++i]);
+        else if (arg == "--nv12") nv12 = true;
+        else if (arg == "--recording" && i + 1 < argc) recording_path = argv[++i];
+        else if (arg == "--video" && i + 1 < argc) video_path = argv[++i];
+        else if (arg == "--camera" && i + 1 < argc) camera_index = std::atoi(argv[++i]);
+        else if (arg == "--template-markers" && i + 1 < argc) {
+            std::stringstream ids(argv[++i]);
+            std::string id;
+            while (std::getline(ids, id, ',')) template_marker_ids.push_back(std::atoi(id.c_str()));
+        }
+        else if (arg == "--templates") {
+            template_paths.clear();
+            while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                template_paths.push_back(argv[++i]);
+            }
+        }
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    try {
+        std::unique_ptr<FrameSource> source;
+        if (!recording_path.empty()) source = std::make_unique<ReplaySource>(recording_path, false);
+        else if (!video_path.empty()) source = std::make_unique<VideoCaptureSource>(video_path);
+        else if (camera_index >= 0) source = std::make_unique<VideoCaptureSource>(camera_index, CaptureConfig());
+        else source = std::make_unique<SyntheticSource>(template_paths, template_marker_ids, nv12);
+
+        FrameView frame;
+        int64_t timestamp_us = 0;
+        if (!source->read(frame, timestamp_us)) {
+            throw std::runtime_error("Source has no frames!");
+        }
+
+        // MJPEG frame boyutu değişken: slot, aynı çözünürlükteki BGR frame'i de alabilmeli
+        size_t frame_bytes = frame.data.total() * frame.data.elemSize();
+        size_t slot_capacity = std::max(frame_bytes, static_cast<size_t>(frame.width) * frame.height * 3);
+        SharedFrameWriter writer(shm_name, slots, slot_capacity);
+
+        std::cout << "Publishing " << frame.width << "x" << frame.height << " frames on shared memory: "
+            << shm_name << " (" << slots << " slots, "
+            << (fps > 0 ? std::to_string(fps) + " fps" : std::string("unpaced")) << ")" << std::endl;
+
+        auto next = std::chrono::steady_clock::now();
+        long published = 0;
+        do {
+            if (!writer.write(frame, steadyTimestampUs())) {
+                std::cerr << "Warning: frame does not fit in slot, skipped" << std::endl;
+            }
+            else if (++published % 300 == 0) {
+                std::cout << "Published: " << published << ", claimed-slot skips: "
+                    << writer.claimedSkips() << std::endl;
+            }
+
+            if (fps > 0) {
+                next += std::chrono::microseconds(static_cast<int64_t>(1e6 / fps));
+                std::this_thread::sleep_until(next);
+            }
+        } while ((max_frames <= 0 || published < max_frames) && source->read(frame, timestamp_us));
+
+        writer.close();
+        std::cout << "Published " << published << " frames" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,978 @@
+﻿// Dedektör için doğruluk / hız ölçüm aracı.
+//
+//   MosaicBench accuracy [--templates A.jpg B.jpg ...] [--scenes N] [--frames N] [--warmup N]
+//                        [--recording FILE.mrec]... [--floor ACC] [--seed S] [--template-markers 23,24]
+//       Her çalışma modunu (tam sayım, örnekleme, düşük çözünürlük, NV12 girişi) etiketli
+//       sentetik frame'lerde ve kayıtlarda puanlar; doğruluk - hız Pareto tablosunu yazar.
+//       Bir modun renk / template / rotasyon doğruluğu --floor'un altındaysa 1 döner.
+//       Kayıtlarda etiket olarak kayıttaki sonuçlar kullanılır (referans: --exact ile alınmış kayıt).
+//       MJPEG modlarında JPEG decode ölçülen süreye dahildir, diğerlerinde değildir.
+//       --template-markers: sentetik tahtalar template başına farklı marker ID'siyle çizilir ve
+//       dedektör template'i ID'den alır (--warmup 0 ile ilk frame'den itibaren puanlanabilir).
+//
+//   MosaicBench decode [--templates ...] [--frames N] [--quality Q] [--seed S]
+//       MJPEG giriş yolu: tam BGR decode + tam çözünürlükte tespit (cv::VideoCapture yolu)
+//       ile DCT ölçeklemeli 1/2 - 1/4 gri decode + sadece tahta bölgesinin decode'unu karşılaştırır.
+//
+//   MosaicBench ingest [--templates ...] [--frames N] [--fps F] [--seed S]
+//       Frame alma maliyeti: paylaşımlı bellek halkası (kopyasız / kopyalı) ile frame'lerin
+//       videoya yazılıp cv::VideoCapture ile geri okunduğu yol. --fps 0 (varsayılan): üretici
+//       hep önde, read süresi saf alma maliyetidir; --fps 30: gecikme kameradaki gibi ölçülür.
+//
+//   MosaicBench scaling [--patches 10,100,...] [--layout voronoi|grid] [--patch-size PX]
+//                       [--frames N] [--max-exponent E] [--seed S]
+//       Sentetik template'lerle (10 - 10000 parça) açılış süresi, frame gecikmesi, dijital çıktı
+//       süresi ve bellek. Büyük yarıdaki log-log eğim --max-exponent'i (1.25) aşarsa 1 döner.
+//       Kamera çözünürlüğü parça başına yaklaşık sabit piksel kalacak şekilde büyür (en çok 4K).
+//
+//   MosaicBench generate [--patches N] [--layout voronoi|grid] [--patch-size PX] [--frames N]
+//                        [--out DIR] [--seed S]
+//       DIR/template.png, boyanmış test frame'leri (frame_000.png ...) ve beklenen sonuçlar
+//       (expected.csv, MosaicCMake --batch-out ile aynı format).
+#include "BatchProcessor.h"
+#include "BoardState.h"
+#include "CaptureRecording.h"
+#include "FrameSource.h"
+#include "FrameView.h"
+#include "JpegDecode.h"
+#include "MarkerDetector.h"
+#include "MosaicDetector.h"
+#include "SharedFrameRing.h"
+#include "SyntheticBoard.h"
+#include "TemplateGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int TARGET_MARKER_ID = 23;
+const int64_t FRAME_INTERVAL_US = 33333;
+const int JPEG_QUALITY = 90;
+
+// ===================== ÇALIŞMA MODLARI =====================
+
+enum class InputTransform {
+    None,
+    HalfResolution,     // Kamera yarı çözünürlükte
+    NV12,               // Kameranın NV12 tamponu (--native)
+    MJPEG               // Kameranın MJPEG frame'i (--mjpeg)
+};
+
+struct BenchMode {
+    std::string name;
+    SamplingConfig sampling;
+    InputTransform input;
+    CaptureConfig capture;
+    AccumulatorConfig accumulator = AccumulatorConfig();    // Varsayılan: kapalı
+};
+
+std::vector<BenchMode> benchModes() {
+    std::vector<BenchMode> modes;
+
+    SamplingConfig exact;
+    exact.enabled = false;
+    modes.push_back({ "exact", exact, InputTransform::None, CaptureConfig() });
+
+    for (float error : { 0.01f, 0.02f, 0.05f }) {
+        SamplingConfig sampled;
+        sampled.fill_error = error;
+        std::ostringstream name;
+        name << "sampled-" << error;
+        modes.push_back({ name.str(), sampled, InputTransform::None, CaptureConfig() });
+    }
+
+    modes.push_back({ "half-res", SamplingConfig(), InputTransform::HalfResolution, CaptureConfig() });
+    modes.push_back({ "native-nv12", SamplingConfig(), InputTransform::NV12, CaptureConfig() });
+
+    for (int scale : { 2, 4 }) {
+        CaptureConfig capture;
+        capture.format = CaptureFormat::MJPEG;
+        capture.mjpeg_detection_scale = scale;
+        modes.push_back({ "mjpeg-1/" + std::to_string(scale), SamplingConfig(), InputTransform::MJPEG, capture });
+    }
+
+    AccumulatorConfig exponential;
+    exponential.enabled = true;
+    modes.push_back({ "accum-exp-4", SamplingConfig(), InputTransform::None, CaptureConfig(), exponential });
+
+    AccumulatorConfig box = exponential;
+    box.box = true;
+    modes.push_back({ "accum-box-4", SamplingConfig(), InputTransform::None, CaptureConfig(), box });
+    return modes;
+}
+
+// ===================== ETİKETLİ KORPUS =====================
+
+struct CorpusOptions {
+    std::vector<std::string> template_paths = { "mosaic.jpg", "mosaic_2.jpg" };
+    std::vector<std::string> recordings;
+    int scenes = 8;
+    int frames_per_scene = 20;
+    int warmup_frames = 12;         // Template (10) ve rotasyon (6) oylamasının oturması için
+    uint64_t seed = 12345;
+    std::vector<int> template_marker_ids;  // Boş: tüm tahtalar TARGET_MARKER_ID, görüntüden tanıma
+};
+
+// expected == nullptr: ısınma frame'i, puanlanmaz
+using CorpusCallback = std::function<void(const FrameView& frame, const BoardState* expected)>;
+
+class Corpus {
+private:
+    CorpusOptions options_;
+    std::vector<std::unique_ptr<SyntheticBoard>> boards_;
+
+public:
+    explicit Corpus(const CorpusOptions& options) : options_(options) {
+        SyntheticBoardConfig config;
+        config.marker_id = TARGET_MARKER_ID;
+        for (size_t i = 0; i < options_.template_paths.size(); ++i) {
+            if (i < options_.template_marker_ids.size()) config.marker_id = options_.template_marker_ids[i];
+            boards_.push_back(std::make_unique<SyntheticBoard>(
+                options_.template_paths[i], static_cast<int>(i), config));
+        }
+    }
+
+    // Aynı seed ile her mod birebir aynı frame dizisini görür
+    void forEach(const CorpusCallback& callback) {
+        cv::RNG rng(options_.seed);
+        int template_count = static_cast<int>(boards_.size());
+
+        for (int scene = 0; scene < options_.scenes; ++scene) {
+            SyntheticBoard& board = *boards_[scene % template_count];
+            int rotation = ((scene / template_count) % 4) * 90;
+
+            board.randomize(rng);
+            BoardState expected = board.expectedState(rotation);
+
+            for (int i = 0; i < options_.frames_per_scene; ++i) {
+                cv::Mat frame = board.renderFrame(rotation, rng);
+                callback(makeFrameView(frame, PixelFormat::BGR),
+                    i < options_.warmup_frames ? nullptr : &expected);
+            }
+        }
+
+        for (const auto& path : options_.recordings) {
+            CaptureReplay replay(path);
+            for (size_t i = 0; i < replay.frameCount(); ++i) {
+                FrameView frame;
+                int64_t timestamp_us = 0;
+                BoardState expected;
+                if (!replay.readFrame(i, frame, timestamp_us)) continue;
+
+                bool labeled = replay.readResult(i, expected) && expected.board_visible &&
+                    static_cast<int>(i) >= options_.warmup_frames;
+                callback(frame, labeled ? &expected : nullptr);
+            }
+        }
+    }
+};
+
+// ===================== PUANLAMA =====================
+
+struct ModeScore {
+    std::string name;
+    long frames = 0;
+    long patches = 0;
+    long color_correct = 0;
+    double fill_error_sum = 0.0;
+    long template_correct = 0;
+    long rotation_correct = 0;
+    long processed_frames = 0;
+    double processing_seconds = 0.0;
+
+    double colorAccuracy() const { return patches > 0 ? static_cast<double>(color_correct) / patches : 0.0; }
+    double fillError() const { return patches > 0 ? fill_error_sum / patches : 0.0; }
+    double templateAccuracy() const { return frames > 0 ? static_cast<double>(template_correct) / frames : 0.0; }
+    double rotationAccuracy() const { return frames > 0 ? static_cast<double>(rotation_correct) / frames : 0.0; }
+    double fps() const { return processing_seconds > 0 ? processed_frames / processing_seconds : 0.0; }
+};
+
+void scoreFrame(const BoardState& expected, const BoardState& actual, ModeScore& score) {
+    score.frames++;
+    score.patches += static_cast<long>(expected.patches.size());
+
+    // Tahta bulunamadıysa veya yanlış template ile sınıflandırıldıysa patch'ler eşleşmez
+    bool comparable = actual.board_visible && actual.patches.size() == expected.patches.size();
+
+    if (actual.board_visible && actual.template_index == expected.template_index) score.template_correct++;
+    if (actual.board_visible && actual.rotation == expected.rotation) score.rotation_correct++;
+
+    for (size_t i = 0; i < expected.patches.size(); ++i) {
+        const PatchState& want = expected.patches[i];
+        if (!comparable) {
+            score.fill_error_sum += want.fill_ratio;
+            continue;
+        }
+        const PatchState& got = actual.patches[i];
+        if (got.color == want.color) score.color_correct++;
+        score.fill_error_sum += std::fabs(got.fill_ratio - want.fill_ratio);
+    }
+}
+
+// Corpus frame'ini modun beklediği kamera girişine çevirir (ölçülen sürenin dışında)
+FrameView transformInput(const FrameView& frame, InputTransform input) {
+    cv::Mat bgr;
+    convertToBGR(frame, bgr);
+
+    switch (input) {
+    case InputTransform::HalfResolution: {
+        cv::Mat half;
+        cv::resize(bgr, half, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+        return makeFrameView(half, PixelFormat::BGR);
+    }
+    case InputTransform::NV12:
+        return makeFrameView(convertToNV12(bgr), PixelFormat::NV12);
+    case InputTransform::MJPEG: {
+        std::vector<uchar> jpeg;
+        cv::imencode(".jpg", bgr, jpeg, { cv::IMWRITE_JPEG_QUALITY, JPEG_QUALITY });
+        return makeFrameView(cv::Mat(jpeg, true).reshape(1, 1), PixelFormat::MJPEG);
+    }
+    default:
+        return makeFrameView(bgr, PixelFormat::BGR);
+    }
+}
+
+ModeScore runMode(const BenchMode& mode, const CorpusOptions& options, Corpus& corpus) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < options.template_paths.size(); ++i) {
+        names.push_back("Template " + std::to_string(i + 1));
+    }
+
+    MosaicDetector detector(options.template_paths, names, TARGET_MARKER_ID, -1);
+    detector.setDisplayEnabled(false);
+    detector.setSamplingConfig(mode.sampling);
+    detector.configureCapture(mode.capture);
+    detector.setTemplateMarkerIds(options.template_marker_ids);
+    detector.setAccumulatorConfig(mode.accumulator);
+
+    ModeScore score;
+    score.name = mode.name;
+    int64_t timestamp_us = 0;
+
+    corpus.forEach([&](const FrameView& frame, const BoardState* expected) {
+        FrameView input = transformInput(frame, mode.input);
+
+        auto start = std::chrono::steady_clock::now();
+        detector.processFrame(input, timestamp_us);
+        score.processing_seconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        score.processed_frames++;
+        timestamp_us += FRAME_INTERVAL_US;
+
+        if (expected) scoreFrame(*expected, detector.getLastState(), score);
+    });
+    return score;
+}
+
+// ===================== RAPOR =====================
+
+// Renk doğruluğu ve hızda kendisinden kesin iyi başka mod yoksa Pareto cephesindedir
+bool onParetoFront(const ModeScore& score, const std::vector<ModeScore>& all) {
+    for (const auto& other : all) {
+        bool no_worse = other.colorAccuracy() >= score.colorAccuracy() && other.fps() >= score.fps();
+        bool better = other.colorAccuracy() > score.colorAccuracy() || other.fps() > score.fps();
+        if (no_worse && better) return false;
+    }
+    return true;
+}
+
+bool printAccuracyTable(const std::vector<ModeScore>& scores, double floor) {
+    bool all_pass = true;
+
+    std::cout << "\n" << std::left << std::setw(16) << "mode"
+        << std::right << std::setw(10) << "color%"
+        << std::setw(10) << "fill MAE"
+        << std::setw(11) << "template%"
+        << std::setw(11) << "rotation%"
+        << std::setw(10) << "fps"
+        << std::setw(8) << "pareto"
+        << std::setw(7) << "floor" << std::endl;
+
+    for (const auto& score : scores) {
+        bool pass = score.colorAccuracy() >= floor && score.templateAccuracy() >= floor &&
+            score.rotationAccuracy() >= floor;
+        all_pass = all_pass && pass;
+
+        std::cout << std::left << std::setw(16) << score.name << std::right << std::fixed
+            << std::setw(10) << std::setprecision(2) << 100.0 * score.colorAccuracy()
+            << std::setw(10) << std::setprecision(4) << score.fillError()
+            << std::setw(11) << std::setprecision(2) << 100.0 * score.templateAccuracy()
+            << std::setw(11) << 100.0 * score.rotationAccuracy()
+            << std::setw(10) << std::setprecision(1) << score.fps()
+            << std::setw(8) << (onParetoFront(score, scores) ? "*" : "")
+            << std::setw(7) << (pass ? "ok" : "FAIL") << std::endl;
+    }
+    std::cout << "\nfloor: " << floor << " (color, template and rotation accuracy)" << std::endl;
+    return all_pass;
+}
+
+int runAccuracy(const CorpusOptions& options, double floor) {
+    Corpus corpus(options);
+
+    std::vector<ModeScore> scores;
+    for (const auto& mode : benchModes()) {
+        std::cout << "Running mode: " << mode.name << std::endl;
+        scores.push_back(runMode(mode, options, corpus));
+    }
+    return printAccuracyTable(scores, floor) ? 0 : 1;
+}
+
+// ===================== MJPEG DECODE =====================
+
+struct DecodeTiming {
+    std::string name;
+    double decode_seconds = 0.0;
+    double detect_seconds = 0.0;
+    double region_seconds = 0.0;
+    long frames = 0;
+    long detected = 0;
+    double corner_error_sum = 0.0;      // Tam çözünürlük tespitine göre (piksel)
+    long corner_samples = 0;
+};
+
+std::unique_ptr<MarkerDetector> makeMarkerDetector() {
+    // MosaicDetector ile aynı sözlük ve parametreler
+    cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_250);
+    cv::aruco::DetectorParameters params;
+    params.cornerRefinementMethod = cv::aruco::CORNER_REFINE_SUBPIX;
+    return std::make_unique<MarkerDetector>(TARGET_MARKER_ID, dictionary, params);
+}
+
+double elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runDecode(const CorpusOptions& options, int frame_count, int quality) {
+    SyntheticBoardConfig config;
+    config.marker_id = TARGET_MARKER_ID;
+    std::vector<std::unique_ptr<SyntheticBoard>> boards;
+    for (size_t i = 0; i < options.template_paths.size(); ++i) {
+        boards.push_back(std::make_unique<SyntheticBoard>(options.template_paths[i], static_cast<int>(i), config));
+    }
+
+    auto detector = makeMarkerDetector();
+    std::vector<DecodeTiming> timings = { { "full BGR decode" }, { "reduced 1/2" }, { "reduced 1/4" } };
+    const int scales[] = { 1, 2, 4 };
+
+    cv::RNG rng(options.seed);
+    for (int f = 0; f < frame_count; ++f) {
+        SyntheticBoard& board = *boards[f % boards.size()];
+        if (f < static_cast<int>(boards.size())) board.randomize(rng);
+
+        std::vector<uchar> encoded;
+        cv::imencode(".jpg", board.renderFrame(((f / 4) % 4) * 90, rng), encoded,
+            { cv::IMWRITE_JPEG_QUALITY, quality });
+        cv::Mat jpeg = cv::Mat(encoded, true).reshape(1, 1);
+
+        std::vector<cv::Point2f> reference;
+        for (size_t t = 0; t < timings.size(); ++t) {
+            DecodeTiming& timing = timings[t];
+            int scale = scales[t];
+            timing.frames++;
+
+            // --- Marker tespiti için decode ---
+            auto start = std::chrono::steady_clock::now();
+            cv::Mat full_bgr, detection_image;
+            if (scale == 1) {
+                full_bgr = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+                detection_image = full_bgr;
+            }
+            else {
+                detection_image = decodeJpegReducedGray(jpeg, scale);
+            }
+            timing.decode_seconds += elapsedSince(start);
+
+            start = std::chrono::steady_clock::now();
+            std::vector<std::vector<cv::Point2f>> markers;
+            bool found = detector->detectMarkers(detection_image, markers);
+            timing.detect_seconds += elapsedSince(start);
+            if (!found) continue;
+
+            float pixel_center = (scale - 1) * 0.5f;
+            for (auto& marker : markers) {
+                for (auto& pt : marker) pt = cv::Point2f(pt.x * scale + pixel_center, pt.y * scale + pixel_center);
+            }
+            std::vector<cv::Point2f> corners = detector->orderCorners(markers);
+            if (corners.size() != 4) continue;
+            timing.detected++;
+
+            // --- Renk sınıflandırması için tahta bölgesi ---
+            start = std::chrono::steady_clock::now();
+            cv::Rect region = cv::boundingRect(corners);
+            region.x -= 2;
+            region.y -= 2;
+            region.width += 4;
+            region.height += 4;
+            cv::Mat board_bgr;
+            cv::Point offset;
+            if (scale == 1) {
+                board_bgr = full_bgr(region & cv::Rect(0, 0, full_bgr.cols, full_bgr.rows));
+            }
+            else {
+                decodeJpegRegion(jpeg, region, board_bgr, offset);
+            }
+            timing.region_seconds += elapsedSince(start);
+
+            if (scale == 1) {
+                reference = corners;
+            }
+            else if (reference.size() == corners.size()) {
+                for (size_t i = 0; i < corners.size(); ++i) {
+                    timing.corner_error_sum += cv::norm(corners[i] - reference[i]);
+                    timing.corner_samples++;
+                }
+            }
+        }
+    }
+
+#ifdef MOSAIC_WITH_LIBJPEG_TURBO
+    const char* region_decoder = "libjpeg-turbo crop";
+#else
+    const char* region_decoder = "full decode + ROI";
+#endif
+    std::cout << "\nMJPEG decode (" << frame_count << " frames, quality " << quality
+        << ", region decode: " << region_decoder << ")\n\n"
+        << std::left << std::setw(18) << "path" << std::right
+        << std::setw(12) << "decode ms" << std::setw(12) << "detect ms" << std::setw(12) << "region ms"
+        << std::setw(12) << "total ms" << std::setw(11) << "detected" << std::setw(14) << "corner err px"
+        << std::endl;
+
+    for (const auto& timing : timings) {
+        double n = std::max<long>(1, timing.frames);
+        double total = timing.decode_seconds + timing.detect_seconds + timing.region_seconds;
+        std::cout << std::left << std::setw(18) << timing.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << 1000.0 * timing.decode_seconds / n
+            << std::setw(12) << 1000.0 * timing.detect_seconds / n
+            << std::setw(12) << 1000.0 * timing.region_seconds / n
+            << std::setw(12) << 1000.0 * total / n
+            << std::setw(11) << (std::to_string(timing.detected) + "/" + std::to_string(timing.frames));
+        if (timing.corner_samples > 0) {
+            std::cout << std::setw(14) << std::setprecision(2) << timing.corner_error_sum / timing.corner_samples;
+        }
+        else {
+            std::cout << std::setw(14) << "-";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+// ===================== FRAME ALMA =====================
+
+const char* INGEST_SHM_NAME = "mosaic_bench_frames";
+const char* INGEST_VIDEO_PATH = "mosaic_bench_ingest.avi";
+const int INGEST_DISTINCT_FRAMES = 16;
+
+struct IngestTiming {
+    std::string name;
+    double read_seconds = 0.0;          // read() + (kopyalı modda) kopya
+    double process_seconds = 0.0;
+    double latency_us_sum = 0.0;        // Üreticinin yayınından frame'in kullanılabilir olmasına
+    long latency_samples = 0;
+    long frames = 0;
+    uint64_t dropped = 0;
+};
+
+// Frame'leri kaynaktan alıp dedektörden geçirir
+void consumeFrames(FrameSource& source, MosaicDetector& detector, int frame_count,
+    bool copy_frame, bool measure_latency, IngestTiming& timing) {
+
+    FrameView frame;
+    int64_t timestamp_us = 0;
+    for (int i = 0; i < frame_count; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!source.read(frame, timestamp_us)) break;
+        if (copy_frame) frame.data = frame.data.clone();
+        timing.read_seconds += elapsedSince(start);
+
+        if (measure_latency) {
+            timing.latency_us_sum += static_cast<double>(steadyTimestampUs() - timestamp_us);
+            timing.latency_samples++;
+        }
+
+        start = std::chrono::steady_clock::now();
+        detector.processFrame(frame, timestamp_us);
+        timing.process_seconds += elapsedSince(start);
+        timing.frames++;
+    }
+}
+
+IngestTiming runSharedMemoryIngest(const std::vector<cv::Mat>& frames, MosaicDetector& detector,
+    int frame_count, double fps, bool copy_frame) {
+
+    IngestTiming timing;
+    timing.name = copy_frame ? "shm + copy" : "shm zero-copy";
+
+    SharedFrameWriter writer(INGEST_SHM_NAME, 4, frames[0].total() * frames[0].elemSize());
+    SharedMemoryFrameSource source(INGEST_SHM_NAME);
+
+    std::atomic<bool> stop_producer(false);
+    std::thread producer([&]() {
+        auto next = std::chrono::steady_clock::now();
+        for (size_t i = 0; !stop_producer.load(); ++i) {
+            writer.write(makeFrameView(frames[i % frames.size()], PixelFormat::BGR), steadyTimestampUs());
+            if (fps > 0) {
+                next += std::chrono::microseconds(static_cast<int64_t>(1e6 / fps));
+                std::this_thread::sleep_until(next);
+            }
+        }
+        writer.close();
+    });
+
+    consumeFrames(source, detector, frame_count, copy_frame, true, timing);
+    timing.dropped = source.droppedFrames();
+
+    stop_producer = true;
+    producer.join();
+    return timing;
+}
+
+// Bugünkü yol: harici sürecin frame'leri dosyaya yazılır, cv::VideoCapture ile okunur
+IngestTiming runVideoIngest(const std::vector<cv::Mat>& frames, MosaicDetector& detector, int frame_count) {
+    IngestTiming timing;
+    timing.name = "video file (MJPG)";
+
+    {
+        cv::VideoWriter writer(INGEST_VIDEO_PATH, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
+            30.0, frames[0].size());
+        if (!writer.isOpened()) {
+            throw std::runtime_error("Failed to create video: " + std::string(INGEST_VIDEO_PATH));
+        }
+        for (int i = 0; i < frame_count; ++i) writer.write(frames[i % frames.size()]);
+    }
+
+    {
+        VideoCaptureSource source(INGEST_VIDEO_PATH);
+        consumeFrames(source, detector, frame_count, false, false, timing);
+    }
+    std::remove(INGEST_VIDEO_PATH);
+    return timing;
+}
+
+int runIngest(const CorpusOptions& options, int frame_count, double fps) {
+    SyntheticBoardConfig config;
+    config.marker_id = TARGET_MARKER_ID;
+    SyntheticBoard board(options.template_paths[0], 0, config);
+
+    cv::RNG rng(options.seed);
+    board.randomize(rng);
+    std::vector<cv::Mat> frames;
+    for (int i = 0; i < INGEST_DISTINCT_FRAMES; ++i) {
+        frames.push_back(board.renderFrame(0, rng));
+    }
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < options.template_paths.size(); ++i) {
+        names.push_back("Template " + std::to_string(i + 1));
+    }
+
+    std::vector<IngestTiming> timings;
+    for (int mode = 0; mode < 3; ++mode) {
+        MosaicDetector detector(options.template_paths, names, TARGET_MARKER_ID, -1);
+        detector.setDisplayEnabled(false);
+
+        if (mode == 2) timings.push_back(runVideoIngest(frames, detector, frame_count));
+        else timings.push_back(runSharedMemoryIngest(frames, detector, frame_count, fps, mode == 1));
+    }
+
+    std::cout << "\nFrame ingest (" << frame_count << " frames " << frames[0].cols << "x" << frames[0].rows
+        << ", producer " << (fps > 0 ? std::to_string(static_cast<int>(fps)) + " fps" : std::string("unpaced"))
+        << ")\n\n"
+        << std::left << std::setw(20) << "source" << std::right
+        << std::setw(12) << "read us" << std::setw(14) << "latency us" << std::setw(13) << "process ms"
+        << std::setw(10) << "frames" << std::setw(10) << "dropped" << std::endl;
+
+    for (const auto& timing : timings) {
+        double n = std::max<long>(1, timing.frames);
+        std::cout << std::left << std::setw(20) << timing.name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << 1e6 * timing.read_seconds / n;
+        if (timing.latency_samples > 0) {
+            std::cout << std::setw(14) << timing.latency_us_sum / timing.latency_samples;
+        }
+        else {
+            std::cout << std::setw(14) << "-";
+        }
+        std::cout << std::setw(13) << std::setprecision(2) << 1000.0 * timing.process_seconds / n
+            << std::setw(10) << timing.frames << std::setw(10) << timing.dropped << std::endl;
+    }
+    return 0;
+}
+
+// ===================== ÖLÇEKLEME =====================
+
+struct ScalingOptions {
+    std::vector<int> patch_counts = { 10, 30, 100, 300, 1000, 3000, 10000 };
+    TemplateGeneratorConfig generator;
+    double max_exponent = 1.25;
+};
+
+struct ScalingRow {
+    int requested = 0;
+    size_t patches = 0;                 // TemplateProcessor'ın bulduğu parça sayısı
+    cv::Size frame_size;
+    double contours_ms = 0.0;           // Template okuma + kontur çıkarma
+    double startup_ms = 0.0;            // MosaicDetector kurulumu
+    double first_frame_ms = 0.0;        // Patch maskelerinin hazırlandığı ilk frame
+    double frame_ms = 0.0;
+    double frame_p95_ms = 0.0;
+    double render_ms = 0.0;             // DigitalRenderer, ilk çizim hariç
+    double memory_mb = 0.0;             // Dedektör + dijital çıktının RSS artışı
+    double color_accuracy = 0.0;
+};
+
+size_t residentMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Kamera parça başına ~patch_size piksel görecek kadar büyür: 720p'den 4K'ya
+cv::Size scalingFrameSize(int patch_count, int patch_size) {
+    int height = static_cast<int>(std::sqrt(static_cast<double>(patch_count)) * patch_size);
+    height = std::min(std::max(height, 720), 2160) & ~1;
+    return cv::Size((height * 16 / 9) & ~1, height);
+}
+
+cv::Scalar patchColorBGR(PatchColor color) {
+    switch (color) {
+    case PatchColor::Red: return cv::Scalar(0, 0, 255);
+    case PatchColor::Orange: return cv::Scalar(0, 165, 255);
+    case PatchColor::Yellow: return cv::Scalar(0, 255, 255);
+    case PatchColor::Green: return cv::Scalar(0, 255, 0);
+    case PatchColor::Blue: return cv::Scalar(255, 0, 0);
+    case PatchColor::Purple: return cv::Scalar(255, 0, 255);
+    default: return cv::Scalar(255, 255, 255);
+    }
+}
+
+// Dijital çıktı için patch bilgileri (ekranda çizilen durumun karşılığı)
+std::vector<PatchInfo> patchInfosFor(const BoardState& state, const std::vector<cv::Point>& centroids) {
+    std::vector<PatchInfo> infos;
+    for (size_t i = 0; i < state.patches.size() && i < centroids.size(); ++i) {
+        PatchInfo info;
+        info.patch_id = static_cast<int>(i);
+        info.color_name = patchColorName(state.patches[i].color);
+        info.color = patchColorBGR(state.patches[i].color);
+        info.fill_ratio = state.patches[i].fill_ratio;
+        info.centroid = centroids[i];
+        infos.push_back(info);
+    }
+    return infos;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+ScalingRow runScalingPoint(int patch_count, const ScalingOptions& scaling, const CorpusOptions& options,
+    const std::string& template_path) {
+
+    TemplateGeneratorConfig generator = scaling.generator;
+    generator.patch_count = patch_count;
+    cv::imwrite(template_path, generateTemplate(generator));
+
+    ScalingRow row;
+    row.requested = patch_count;
+    row.frame_size = scalingFrameSize(patch_count, generator.patch_size);
+
+    auto start = std::chrono::steady_clock::now();
+    TemplateProcessor template_processor(template_path);
+    row.contours_ms = 1000.0 * elapsedSince(start);
+    row.patches = template_processor.getContours().size();
+
+    SyntheticBoardConfig board_config;
+    board_config.marker_id = TARGET_MARKER_ID;
+    board_config.frame_size = row.frame_size;
+    SyntheticBoard board(template_path, 0, board_config);
+
+    std::vector<cv::Point> centroids;
+    for (const auto& contour : template_processor.getContours()) {
+        cv::Moments m = cv::moments(contour);
+        cv::Rect bounds = cv::boundingRect(contour);
+        centroids.push_back(m.m00 > 0
+            ? cv::Point(static_cast<int>(m.m10 / m.m00), static_cast<int>(m.m01 / m.m00))
+            : cv::Point(bounds.x + bounds.width / 2, bounds.y + bounds.height / 2));
+    }
+    DigitalRenderer renderer(template_processor);
+
+    size_t baseline = residentMemoryBytes();
+    start = std::chrono::steady_clock::now();
+    MosaicDetector detector({ template_path }, { "Generated" }, TARGET_MARKER_ID, -1);
+    row.startup_ms = 1000.0 * elapsedSince(start);
+    detector.setDisplayEnabled(false);
+
+    ModeScore score;
+    std::vector<double> frame_ms, render_ms;
+    cv::RNG rng(options.seed);
+    int warmup = std::min(options.warmup_frames, options.frames_per_scene / 2);
+
+    for (int i = 0; i < options.frames_per_scene; ++i) {
+        // Durum birkaç frame'de bir değişir: ColorHistory ve kısmi yeniden çizim gerçekçi kalır
+        if (i % 10 == 0) board.randomize(rng);
+        cv::Mat frame = board.renderFrame(0, rng);
+
+        start = std::chrono::steady_clock::now();
+        detector.processFrame(makeFrameView(frame, PixelFormat::BGR), i * FRAME_INTERVAL_US);
+        double ms = 1000.0 * elapsedSince(start);
+        if (i == 0) row.first_frame_ms = ms;
+        else frame_ms.push_back(ms);
+
+        BoardState expected = board.expectedState(0);
+        if (i >= warmup) scoreFrame(expected, detector.getLastState(), score);
+
+        start = std::chrono::steady_clock::now();
+        renderer.render(template_processor.getOutputSize(), 0, patchInfosFor(expected, centroids));
+        if (i > 0) render_ms.push_back(1000.0 * elapsedSince(start));
+    }
+
+    size_t resident = residentMemoryBytes();
+    row.memory_mb = resident > baseline ? (resident - baseline) / (1024.0 * 1024.0) : 0.0;
+    for (double ms : frame_ms) row.frame_ms += ms / frame_ms.size();
+    for (double ms : render_ms) row.render_ms += ms / render_ms.size();
+    row.frame_p95_ms = percentile(frame_ms, 0.95);
+    row.color_accuracy = score.colorAccuracy();
+    return row;
+}
+
+// log-log eğim (en küçük kareler): 1 doğrusal, > 1 doğrusaldan hızlı büyüme
+double scalingExponent(const std::vector<ScalingRow>& rows, size_t first, double ScalingRow::* metric) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = 0;
+    for (size_t i = first; i < rows.size(); ++i) {
+        if (rows[i].patches == 0 || rows[i].*metric <= 0.0) continue;
+        double x = std::log(static_cast<double>(rows[i].patches));
+        double y = std::log(rows[i].*metric);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+        n++;
+    }
+    double denominator = n * sxx - sx * sx;
+    return n >= 2 && denominator > 0 ? (n * sxy - sx * sy) / denominator : 0.0;
+}
+
+int runScaling(const ScalingOptions& scaling, const CorpusOptions& options) {
+    std::vector<ScalingRow> rows;
+    for (int count : scaling.patch_counts) {
+        std::string template_path = (std::filesystem::temp_directory_path() /
+            ("mosaic_scaling_" + std::to_string(count) + ".png")).string();
+        rows.push_back(runScalingPoint(count, scaling, options, template_path));
+        std::remove(template_path.c_str());
+        std::cerr << "  " << count << " patches done" << std::endl;
+    }
+
+    std::cout << "\nPatch-count scaling (" << (scaling.generator.layout == TemplateLayout::Grid ? "grid" : "voronoi")
+        << ", ~" << scaling.generator.patch_size << " px/patch, " << options.frames_per_scene << " frames)\n\n"
+        << std::right << std::setw(8) << "patches" << std::setw(11) << "frame"
+        << std::setw(12) << "contours" << std::setw(11) << "startup" << std::setw(13) << "1st frame"
+        << std::setw(10) << "frame" << std::setw(10) << "p95" << std::setw(10) << "render"
+        << std::setw(10) << "mem MB" << std::setw(8) << "color" << "\n"
+        << std::setw(8) << "" << std::setw(11) << "" << std::setw(12) << "ms" << std::setw(11) << "ms"
+        << std::setw(13) << "ms" << std::setw(10) << "ms" << std::setw(10) << "ms" << std::setw(10) << "ms"
+        << std::endl;
+
+    for (const auto& row : rows) {
+        std::cout << std::setw(8) << row.patches
+            << std::setw(11) << (std::to_string(row.frame_size.width) + "x" + std::to_string(row.frame_size.height))
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << row.contours_ms << std::setw(11) << row.startup_ms
+            << std::setw(13) << row.first_frame_ms << std::setw(10) << row.frame_ms
+            << std::setw(10) << row.frame_p95_ms << std::setw(10) << row.render_ms
+            << std::setw(10) << row.memory_mb << std::setw(8) << std::setprecision(3) << row.color_accuracy
+            << std::endl;
+    }
+
+    // Sabit maliyetler küçük tahtalarda eğimi düşürür; büyük yarıya bakılır
+    size_t first = rows.size() / 2;
+    if (rows.size() - first < 2) first = 0;
+
+    struct Metric {
+        const char* name;
+        double ScalingRow::* field;
+    };
+    const Metric metrics[] = {
+        { "contours", &ScalingRow::contours_ms },
+        { "startup", &ScalingRow::startup_ms },
+        { "1st frame", &ScalingRow::first_frame_ms },
+        { "frame", &ScalingRow::frame_ms },
+        { "render", &ScalingRow::render_ms },
+        { "memory", &ScalingRow::memory_mb }
+    };
+
+    std::cout << "\nlog-log exponent over " << (first < rows.size() ? rows[first].patches : 0) << "+ patches "
+        << "(1 = linear):" << std::endl;
+    bool super_linear = false;
+    for (const auto& metric : metrics) {
+        double exponent = scalingExponent(rows, first, metric.field);
+        bool flagged = exponent > scaling.max_exponent;
+        super_linear = super_linear || flagged;
+        std::cout << "  " << std::left << std::setw(10) << metric.name << std::right << std::setprecision(2)
+            << exponent << (flagged ? "   SUPER-LINEAR" : "") << std::endl;
+    }
+    return super_linear ? 1 : 0;
+}
+
+int runGenerate(const ScalingOptions& scaling, const CorpusOptions& options, const std::string& out_dir) {
+    TemplateGeneratorConfig generator = scaling.generator;
+    generator.patch_count = scaling.patch_counts.front();
+
+    std::filesystem::create_directories(out_dir);
+    std::string template_path = (std::filesystem::path(out_dir) / "template.png").string();
+    cv::imwrite(template_path, generateTemplate(generator));
+
+    SyntheticBoardConfig board_config;
+    board_config.marker_id = TARGET_MARKER_ID;
+    board_config.frame_size = scalingFrameSize(generator.patch_count, generator.patch_size);
+    SyntheticBoard board(template_path, 0, board_config);
+
+    cv::RNG rng(options.seed);
+    board.randomize(rng);
+    std::vector<BoardState> expected;
+    for (int i = 0; i < options.frames_per_scene; ++i) {
+        int rotation = (i % 4) * 90;
+        std::ostringstream name;
+        name << "frame_" << std::setw(3) << std::setfill('0') << i << ".png";
+        cv::imwrite((std::filesystem::path(out_dir) / name.str()).string(), board.renderFrame(rotation, rng));
+
+        expected.push_back(board.expectedState(rotation));
+        expected.back().frame_index = static_cast<uint64_t>(i);
+    }
+
+    std::ofstream csv(std::filesystem::path(out_dir) / "expected.csv");
+    writeBatchResults(expected, csv);
+
+    std::cout << "Generated " << board.patchCount() << " patches (" << generator.patch_count << " requested), "
+        << options.frames_per_scene << " frames in " << out_dir << std::endl;
+    return 0;
+}
+
+void printUsage() {
+    std::cerr << "Usage: MosaicBench accuracy [--templates A.jpg B.jpg ...] [--scenes N] [--frames N]\n"
+        << "                            [--warmup N] [--recording FILE.mrec]... [--floor ACC] [--seed S]\n"
+        << "                            [--template-markers 23,24]\n"
+        << "       MosaicBench decode [--templates ...] [--frames N] [--quality Q] [--seed S]\n"
+        << "       MosaicBench ingest [--templates ...] [--frames N] [--fps F] [--seed S]\n"
+        << "       MosaicBench scaling [--patches 10,100,...] [--layout voronoi|grid] [--patch-size PX]\n"
+        << "                           [--frames N] [--max-exponent E] [--seed S]\n"
+        << "       MosaicBench generate [--patches N] [--layout voronoi|grid] [--patch-size PX] [--frames N]\n"
+        << "                            [--out DIR] [--seed S]"
+        << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return -1;
+    }
+    std::string command = argv[1];
+
+    CorpusOptions options;
+    double floor = 0.95;
+    int jpeg_quality = JPEG_QUALITY;
+    double ingest_fps = 0.0;
+    ScalingOptions scaling;
+    bool patches_given = false;
+    std::string out_dir = "generated";
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--templates") {
+            options.template_paths.clear();
+            while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                options.template_paths.push_back(argv[++i]);
+            }
+        }
+        else if (arg == "--recording" && i + 1 < argc) options.recordings.push_back(argv[++i]);
+        else if (arg == "--template-markers" && i + 1 < argc) {
+            std::stringstream ids(argv[++i]);
+            std::string id;
+            while (std::getline(ids, id, ',')) options.template_marker_ids.push_back(std::atoi(id.c_str()));
+        }
+        else if (arg == "--scenes" && i + 1 < argc) options.scenes = std::atoi(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc) options.frames_per_scene = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc) options.warmup_frames = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--floor" && i + 1 < argc) floor = std::atof(argv[++i]);
+        else if (arg == "--quality" && i + 1 < argc) jpeg_quality = std::atoi(argv[++i]);
+        else if (arg == "--fps" && i + 1 < argc) ingest_fps = std::atof(argv[++i]);
+        else if (arg == "--patches" && i + 1 < argc) {
+            scaling.patch_counts.clear();
+            patches_given = true;
+            std::stringstream counts(argv[++i]);
+            std::string count;
+            while (std::getline(counts, count, ',')) scaling.patch_counts.push_back(std::atoi(count.c_str()));
+        }
+        else if (arg == "--layout" && i + 1 < argc) scaling.generator.layout = parseTemplateLayout(argv[++i]);
+        else if (arg == "--patch-size" && i + 1 < argc) scaling.generator.patch_size = std::atoi(argv[++i]);
+        else if (arg == "--max-exponent" && i + 1 < argc) scaling.max_exponent = std::atof(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    try {
+        if (command == "accuracy") {
+            return runAccuracy(options, floor);
+        }
+        if (command == "decode") {
+            // decode'da --frames toplam frame sayısıdır
+            return runDecode(options, options.frames_per_scene * options.scenes, jpeg_quality);
+        }
+        if (command == "ingest") {
+            return runIngest(options, options.frames_per_scene * options.scenes, ingest_fps);
+        }
+        if (command == "scaling" || command == "generate") {
+            if (scaling.patch_counts.empty()) throw std::runtime_error("--patches needs at least one count");
+            scaling.generator.seed = options.seed;
+            if (command == "generate" && !patches_given) scaling.patch_counts = { 1000 };
+            return command == "scaling" ? runScaling(scaling, options) : runGenerate(scaling, options, out_dir);
+        }
+        printUsage();
+        return -1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,328 @@
+﻿// Sonuç yayını için referans tüketici.
+//
+//   ResultConsumer [--shm NAME]                 Paylaşımlı bellekten oku ve yazdır
+//   ResultConsumer --socket PATH                Unix socket'ten oku ve yazdır
+//   ResultConsumer --bench [N] [PATCHES] [--rate MSG_PER_S] [--socket PATH]
+//                                               Yayıncı + tüketici throughput / gecikme ölçümü
+//                                               (--rate 0: sınırsız, sadece throughput anlamlı)
+#include "BoardState.h"
+#include "MessageRing.h"
+#include "ResultProtocol.h"
+#include "ResultPublisher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static int64_t steadyTimestampUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printMessage(const ResultMessage& message, const std::vector<PatchUpdate>& board) {
+    if (message.type == ResultMessageType::BoardLost) {
+        std::cout << "#" << message.sequence << " LOST  frame=" << message.frame_index
+            << " t=" << message.timestamp_us << std::endl;
+        return;
+    }
+
+    std::cout << "#" << message.sequence
+        << (message.type == ResultMessageType::FullSnapshot ? " FULL " : " DELTA")
+        << " frame=" << message.frame_index
+        << " t=" << message.timestamp_us
+        << " template=" << message.template_index
+        << " rotation=" << message.rotation
+        << " updates=" << message.updates.size() << "/" << message.patch_count;
+
+    int colored = 0;
+    for (const auto& patch : board) {
+        if (patch.color != PatchColor::White) colored++;
+    }
+    std::cout << " colored=" << colored << std::endl;
+
+    for (const auto& update : message.updates) {
+        if (message.type == ResultMessageType::FullSnapshot && update.color == PatchColor::White) continue;
+        std::cout << "    patch " << update.patch_id << ": " << patchColorName(update.color)
+            << " " << (update.fill_permille / 10.0) << "%" << std::endl;
+    }
+}
+
+static int consumeSharedMemory(const std::string& shm_name) {
+    MessageRingReader reader(shm_name);
+    std::vector<uint8_t> buffer;
+    std::vector<PatchUpdate> board;
+    int board_template = -1;
+    bool board_visible = false;
+    bool synced = false;
+    ResultMessage message;
+
+    std::cout << "Listening on shared memory: " << shm_name << std::endl;
+    while (true) {
+        RingReadResult result = reader.read(buffer);
+        if (result == RingReadResult::Empty) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (result == RingReadResult::Overrun) {
+            std::cerr << "Overrun - waiting for next full snapshot" << std::endl;
+            synced = false;
+            continue;
+        }
+        if (!decodeResultMessage(buffer.data(), buffer.size(), message)) {
+            std::cerr << "Malformed message" << std::endl;
+            continue;
+        }
+        if (!synced && message.type != ResultMessageType::FullSnapshot) continue;
+
+        synced = applyResultMessage(message, board, board_template, board_visible);
+        if (synced) printMessage(message, board);
+    }
+    return 0;
+}
+
+#ifndef _WIN32
+
+static int connectSocket(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool readExact(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool readFramed(int fd, std::vector<uint8_t>& buffer) {
+    uint8_t prefix[4];
+    if (!readExact(fd, prefix, sizeof(prefix))) return false;
+    uint32_t length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) |
+        (static_cast<uint32_t>(prefix[3]) << 24);
+    buffer.resize(length);
+    return readExact(fd, buffer.data(), length);
+}
+
+static int consumeSocket(const std::string& path) {
+    int fd = connectSocket(path);
+    if (fd < 0) {
+        std::cerr << "Error: could not connect to " << path << std::endl;
+        return -1;
+    }
+
+    std::vector<uint8_t> buffer;
+    std::vector<PatchUpdate> board;
+    int board_template = -1;
+    bool board_visible = false;
+    ResultMessage message;
+
+    std::cout << "Connected to socket: " << path << std::endl;
+    while (readFramed(fd, buffer)) {
+        if (!decodeResultMessage(buffer.data(), buffer.size(), message)) {
+            std::cerr << "Malformed message" << std::endl;
+            continue;
+        }
+        if (applyResultMessage(message, board, board_template, board_visible)) {
+            printMessage(message, board);
+        }
+    }
+    close(fd);
+    std::cout << "Publisher closed the connection" << std::endl;
+    return 0;
+}
+
+#else
+
+static int consumeSocket(const std::string&) {
+    std::cerr << "Error: Unix socket input is not supported on this platform" << std::endl;
+    return -1;
+}
+
+#endif
+
+// ===================== THROUGHPUT / GECİKME ÖLÇÜMÜ =====================
+
+struct LatencyStats {
+    std::vector<int64_t> samples;
+    long long received = 0;
+    long long overruns = 0;
+};
+
+static void printStats(const std::string& label, LatencyStats& stats, long long published,
+    double seconds) {
+    std::sort(stats.samples.begin(), stats.samples.end());
+    auto percentile = [&stats](double p) -> long long {
+        if (stats.samples.empty()) return 0;
+        size_t index = static_cast<size_t>(p * (stats.samples.size() - 1));
+        return static_cast<long long>(stats.samples[index]);
+    };
+
+    std::cout << label << ": published " << published << " in " << seconds << " s ("
+        << static_cast<long long>(published / seconds) << " msg/s), received "
+        << stats.received << ", overruns " << stats.overruns << std::endl;
+    std::cout << "    latency us: p50=" << percentile(0.5) << " p99=" << percentile(0.99)
+        << " max=" << percentile(1.0) << std::endl;
+}
+
+static int runBenchmark(long long message_count, int patch_count, double rate,
+    const std::string& socket_path) {
+    PublisherConfig config;
+    config.shm_name = "mosaic_results_bench";
+    config.socket_path = socket_path;
+    ResultPublisher publisher(config);
+
+    MessageRingReader reader(config.shm_name);
+
+#ifndef _WIN32
+    // Socket tüketicisi ayrı thread'de okur, yoksa gönderim tamponu dolar
+    LatencyStats socket_stats;
+    int socket_fd = socket_path.empty() ? -1 : connectSocket(socket_path);
+    std::thread socket_consumer;
+    if (socket_fd >= 0) {
+        timeval timeout = { 0, 200000 };
+        setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        socket_consumer = std::thread([&socket_stats, socket_fd]() {
+            std::vector<uint8_t> socket_buffer;
+            ResultMessage socket_message;
+            while (readFramed(socket_fd, socket_buffer)) {
+                int64_t now = steadyTimestampUs();
+                if (decodeResultMessage(socket_buffer.data(), socket_buffer.size(), socket_message)) {
+                    socket_stats.samples.push_back(now - socket_message.timestamp_us);
+                    socket_stats.received++;
+                }
+            }
+        });
+    }
+#endif
+
+    // Tipik bir frame: patch'lerin ~%5'i değişir
+    BoardState state;
+    state.template_index = 0;
+    state.rotation = 0;
+    state.board_visible = true;
+    state.patches.assign(patch_count, PatchState{ PatchColor::White, 0.0f });
+
+    std::atomic<bool> done(false);
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]() {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> patch_dist(0, patch_count - 1);
+        std::uniform_int_distribution<int> color_dist(0, 6);
+        std::uniform_real_distribution<float> fill_dist(0.15f, 1.0f);
+        int changes = std::max(1, patch_count / 20);
+        auto next_publish = std::chrono::steady_clock::now();
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(rate > 0 ? 1.0 / rate : 0.0));
+
+        for (long long i = 0; i < message_count; ++i) {
+            if (rate > 0) {
+                next_publish += period;
+                std::this_thread::sleep_until(next_publish);
+            }
+            for (int c = 0; c < changes; ++c) {
+                PatchState& patch = state.patches[patch_dist(rng)];
+                patch.color = static_cast<PatchColor>(color_dist(rng));
+                patch.fill_ratio = fill_dist(rng);
+            }
+            state.frame_index = static_cast<uint64_t>(i);
+            state.timestamp_us = steadyTimestampUs();
+            publisher.publish(state);
+        }
+        done = true;
+    });
+
+    LatencyStats shm_stats;
+    std::vector<uint8_t> buffer;
+    ResultMessage message;
+    while (true) {
+        RingReadResult result = reader.read(buffer);
+        if (result == RingReadResult::Message) {
+            int64_t now = steadyTimestampUs();
+            if (decodeResultMessage(buffer.data(), buffer.size(), message)) {
+                shm_stats.samples.push_back(now - message.timestamp_us);
+                shm_stats.received++;
+            }
+        }
+        else if (result == RingReadResult::Overrun) {
+            shm_stats.overruns++;
+        }
+        else if (done) {
+            break;
+        }
+    }
+
+    producer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Patches: " << patch_count << ", last message: "
+        << publisher.lastMessageSize() << " bytes" << std::endl;
+    printStats("Shared memory", shm_stats, static_cast<long long>(publisher.publishedCount()), seconds);
+
+#ifndef _WIN32
+    if (socket_consumer.joinable()) {
+        socket_consumer.join();
+        close(socket_fd);
+        printStats("Unix socket", socket_stats, static_cast<long long>(publisher.publishedCount()), seconds);
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string shm_name = "mosaic_results";
+    std::string socket_path;
+    bool bench = false;
+    double rate = 0.0;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) shm_name = argv[++i];
+        else if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--bench") bench = true;
+        else if (arg == "--rate" && i + 1 < argc) rate = std::atof(argv[++i]);
+        else positional.push_back(arg);
+    }
+
+    try {
+        if (bench) {
+            long long count = positional.size() > 0 ? std::atoll(positional[0].c_str()) : 100000;
+            int patches = positional.size() > 1 ? std::atoi(positional[1].c_str()) : 200;
+            return runBenchmark(count, std::max(1, patches), rate, socket_path);
+        }
+        if (!socket_path.empty()) {
+            return consumeSocket(socket_path);
+        }
+        return consumeSharedMemory(shm_name);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,206 @@
+﻿#include "SyntheticBoard.h"
+#include "PatchSampler.h"
+#include <opencv2/aruco.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Dedektörde bunun altındaki doluluk beyaz sayılır (MosaicDetector ile aynı)
+const float MIN_FILL_RATIO_THRESHOLD = 0.15f;
+
+struct PaintColor {
+    PatchColor color;
+    cv::Vec3b bgr;
+};
+
+// ColorDetector eşiklerinin rahatça içinde kalan boya renkleri
+const PaintColor PAINT_COLORS[] = {
+    { PatchColor::Red,    cv::Vec3b(40, 40, 220) },
+    { PatchColor::Orange, cv::Vec3b(30, 140, 250) },
+    { PatchColor::Yellow, cv::Vec3b(40, 220, 230) },
+    { PatchColor::Green,  cv::Vec3b(60, 180, 60) },
+    { PatchColor::Blue,   cv::Vec3b(200, 90, 30) },
+    { PatchColor::Purple, cv::Vec3b(180, 50, 170) }
+};
+
+const cv::Scalar TABLE_COLOR(70, 75, 80);
+
+}
+
+SyntheticBoard::SyntheticBoard(const std::string& template_path, int template_index,
+    const SyntheticBoardConfig& config)
+    : template_index_(template_index), config_(config) {
+    template_processor_ = std::make_unique<TemplateProcessor>(template_path);
+    template_image_ = cv::imread(template_path);
+    if (template_image_.empty()) {
+        throw std::runtime_error("Failed to load template: " + template_path);
+    }
+    patches_.assign(template_processor_->getContours().size(), PaintedPatch{ PatchColor::White, 0.0f });
+}
+
+void SyntheticBoard::randomize(cv::RNG& rng) {
+    cv::Mat board = template_image_.clone();
+    const auto& contours = template_processor_->getContours();
+
+    // Gerçek doluluk, dedektörün kullandığı aşındırılmış maske üzerinden ölçülür
+    PatchSampler sampler(*template_processor_);
+    sampler.prepare(board.size());
+
+    for (size_t i = 0; i < contours.size(); ++i) {
+        PaintedPatch& patch = patches_[i];
+        patch = PaintedPatch{ PatchColor::White, 0.0f };
+
+        const auto& points = sampler.samplePoints(i);
+        if (points.empty() || rng.uniform(0.0, 1.0) < config_.white_probability) continue;
+
+        const PaintColor& paint = PAINT_COLORS[rng.uniform(0, 6)];
+        double target_fill = rng.uniform(0.3, 1.0);
+
+        // Patch rastgele bir doğrultuda, kenardan başlayarak boyanır
+        double angle = rng.uniform(0.0, 2.0 * CV_PI);
+        cv::Point2d direction(std::cos(angle), std::sin(angle));
+
+        std::vector<double> projections;
+        projections.reserve(points.size());
+        for (const auto& pt : points) {
+            projections.push_back(pt.x * direction.x + pt.y * direction.y);
+        }
+        std::sort(projections.begin(), projections.end());
+        size_t cut_index = std::min(projections.size() - 1,
+            static_cast<size_t>(target_fill * projections.size()));
+        double cutoff = projections[cut_index];
+
+        cv::Rect bounds = cv::boundingRect(contours[i]) & cv::Rect(cv::Point(0, 0), board.size());
+        cv::Mat mask = cv::Mat::zeros(bounds.size(), CV_8U);
+        std::vector<std::vector<cv::Point>> contour_vec = { contours[i] };
+        cv::drawContours(mask, contour_vec, 0, cv::Scalar(255), cv::FILLED,
+            cv::LINE_8, cv::noArray(), INT_MAX, -bounds.tl());
+
+        for (int y = 0; y < mask.rows; ++y) {
+            for (int x = 0; x < mask.cols; ++x) {
+                if (mask.at<uchar>(y, x) == 0) continue;
+                int bx = bounds.x + x, by = bounds.y + y;
+                if (bx * direction.x + by * direction.y <= cutoff) {
+                    board.at<cv::Vec3b>(by, bx) = paint.bgr;
+                }
+            }
+        }
+
+        size_t painted = 0;
+        for (double projection : projections) {
+            if (projection <= cutoff) painted++;
+        }
+        float fill = static_cast<float>(painted) / static_cast<float>(points.size());
+
+        if (fill >= MIN_FILL_RATIO_THRESHOLD) {
+            patch = PaintedPatch{ paint.color, fill };
+        }
+    }
+
+    buildSheet(board);
+}
+
+void SyntheticBoard::buildSheet(const cv::Mat& board) {
+    int marker_side = std::max(board.cols, board.rows) / 6;
+    int margin = marker_side * 3 / 2;   // Marker + yarım marker beyaz boşluk
+
+    sheet_ = cv::Mat(board.rows + 2 * margin, board.cols + 2 * margin, CV_8UC3, cv::Scalar(255, 255, 255));
+    board.copyTo(sheet_(cv::Rect(margin, margin, board.cols, board.rows)));
+
+    cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_250);
+    cv::Mat marker_gray, marker;
+    cv::aruco::generateImageMarker(dictionary, config_.marker_id, marker_side, marker_gray, 1);
+    cv::cvtColor(marker_gray, marker, cv::COLOR_GRAY2BGR);
+
+    // Her marker'ın tahtaya bakan köşesi tahtanın köşesine denk gelir
+    int near = margin - marker_side;
+    int far = margin + board.cols;
+    int far_y = margin + board.rows;
+    marker.copyTo(sheet_(cv::Rect(near, near, marker_side, marker_side)));
+    marker.copyTo(sheet_(cv::Rect(far, near, marker_side, marker_side)));
+    marker.copyTo(sheet_(cv::Rect(far, far_y, marker_side, marker_side)));
+    marker.copyTo(sheet_(cv::Rect(near, far_y, marker_side, marker_side)));
+}
+
+cv::Mat SyntheticBoard::renderFrame(int rotation, cv::RNG& rng) const {
+    cv::Mat sheet;
+    if (rotation == 90) cv::rotate(sheet_, sheet, cv::ROTATE_90_CLOCKWISE);
+    else if (rotation == 180) cv::rotate(sheet_, sheet, cv::ROTATE_180);
+    else if (rotation == 270) cv::rotate(sheet_, sheet, cv::ROTATE_90_COUNTERCLOCKWISE);
+    else sheet = sheet_;
+
+    cv::Size frame_size = config_.frame_size;
+    double scale = config_.board_scale * frame_size.height / std::max(sheet.cols, sheet.rows);
+    cv::Point2f center(frame_size.width * 0.5f, frame_size.height * 0.5f);
+    float half_w = static_cast<float>(sheet.cols * scale * 0.5);
+    float half_h = static_cast<float>(sheet.rows * scale * 0.5);
+    float jitter = static_cast<float>(config_.perspective_jitter * std::min(frame_size.width, frame_size.height));
+
+    std::vector<cv::Point2f> src = {
+        cv::Point2f(0, 0),
+        cv::Point2f(static_cast<float>(sheet.cols), 0),
+        cv::Point2f(static_cast<float>(sheet.cols), static_cast<float>(sheet.rows)),
+        cv::Point2f(0, static_cast<float>(sheet.rows))
+    };
+    std::vector<cv::Point2f> dst = {
+        center + cv::Point2f(-half_w, -half_h),
+        center + cv::Point2f(half_w, -half_h),
+        center + cv::Point2f(half_w, half_h),
+        center + cv::Point2f(-half_w, half_h)
+    };
+    for (auto& pt : dst) {
+        pt.x += rng.uniform(-jitter, jitter);
+        pt.y += rng.uniform(-jitter, jitter);
+    }
+
+    cv::Mat M = cv::getPerspectiveTransform(src, dst);
+    cv::Mat frame;
+    cv::warpPerspective(sheet, frame, M, frame_size, cv::INTER_LINEAR, cv::BORDER_CONSTANT, TABLE_COLOR);
+
+    // Kamera bulanıklığı ve sensör gürültüsü
+    cv::GaussianBlur(frame, frame, cv::Size(3, 3), 0.8);
+    if (config_.noise_sigma > 0) {
+        cv::Mat noise(frame.size(), CV_16SC3);
+        rng.fill(noise, cv::RNG::NORMAL, 0, config_.noise_sigma);
+        cv::Mat noisy;
+        frame.convertTo(noisy, CV_16SC3);
+        noisy += noise;
+        noisy.convertTo(frame, CV_8UC3);
+    }
+    return frame;
+}
+
+BoardState SyntheticBoard::expectedState(int rotation) const {
+    BoardState state;
+    state.frame_index = 0;
+    state.timestamp_us = 0;
+    state.board_visible = true;
+    state.template_index = template_index_;
+    state.rotation = rotation;
+    for (const auto& patch : patches_) {
+        state.patches.push_back(PatchState{ patch.color, patch.fill_ratio });
+    }
+    return state;
+}
+
+cv::Mat convertToNV12(const cv::Mat& bgr) {
+    cv::Mat i420;
+    cv::cvtColor(bgr, i420, cv::COLOR_BGR2YUV_I420);
+
+    int width = bgr.cols, height = bgr.rows;
+    cv::Mat nv12(height * 3 / 2, width, CV_8UC1);
+    i420.rowRange(0, height).copyTo(nv12.rowRange(0, height));
+
+    // I420: U ve V düzlemleri ayrı, NV12: UV iç içe
+    const uchar* u = i420.ptr<uchar>(height);
+    const uchar* v = u + (width / 2) * (height / 2);
+    uchar* uv = nv12.ptr<uchar>(height);
+    for (int i = 0; i < (width / 2) * (height / 2); ++i) {
+        uv[2 * i] = u[i];
+        uv[2 * i + 1] = v[i];
+    }
+    return nv12;
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "BoardState.h"
+#include "TemplateProcessor.h"
+
+// Benchmark için etiketli sentetik frame üretimi.
+// Template'in patch'leri bilinen renk ve doluluk oranıyla boyanır, tahta dört ArUco
+// marker'ı ile (iç köşeleri tahtanın köşelerinde) kağıda yerleştirilir, sonra
+// döndürülüp hafif perspektif, bulanıklık ve gürültüyle kamera frame'ine çizilir.
+
+struct SyntheticBoardConfig {
+    int marker_id = 23;
+    cv::Size frame_size = cv::Size(1280, 720);
+    double board_scale = 0.85;          // Kağıdın frame yüksekliğine oranı
+    double perspective_jitter = 0.03;   // Köşe kayması (frame kısa kenarına oran)
+    double noise_sigma = 4.0;           // Gauss gürültüsü (0-255)
+    double white_probability = 0.25;    // Boş bırakılan patch oranı
+};
+
+class SyntheticBoard {
+private:
+    struct PaintedPatch {
+        PatchColor color;
+        float fill_ratio;           // Aşındırılmış maske üzerinde gerçek oran
+    };
+
+    std::unique_ptr<TemplateProcessor> template_processor_;
+    cv::Mat template_image_;
+    int template_index_;
+    SyntheticBoardConfig config_;
+
+    cv::Mat sheet_;                     // Tahta + marker'lar, döndürülmemiş
+    std::vector<PaintedPatch> patches_;
+
+    void buildSheet(const cv::Mat& board);
+
+public:
+    SyntheticBoard(const std::string& template_path, int template_index,
+        const SyntheticBoardConfig& config);
+
+    // Patch'lere yeni rastgele renk / doluluk atar
+    void randomize(cv::RNG& rng);
+
+    // rotation: 0/90/180/270 (saat yönünde), MosaicDetector'ın rotasyon tanımıyla aynı
+    cv::Mat renderFrame(int rotation, cv::RNG& rng) const;
+
+    // Dedektörün bu tahta için vermesi gereken sonuç
+    BoardState expectedState(int rotation) const;
+
+    size_t patchCount() const { return patches_.size(); }
+};
+
+// BGR -> NV12 (çift boyutlu frame)
+cv::Mat convertToNV12(const cv::Mat& bgr);
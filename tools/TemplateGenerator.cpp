@@ -0,0 +1,113 @@
+﻿#include "TemplateGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const cv::Scalar LINE_COLOR(0, 0, 0);
+const cv::Scalar BACKGROUND_COLOR(255, 255, 255);
+
+// Voronoi hücreleri görüntü sınırına kırpılmış olarak
+std::vector<std::vector<cv::Point2f>> voronoiCells(const std::vector<cv::Point2f>& sites, cv::Size size) {
+    cv::Subdiv2D subdiv(cv::Rect(0, 0, size.width, size.height));
+    for (const auto& site : sites) {
+        subdiv.insert(site);
+    }
+
+    std::vector<std::vector<cv::Point2f>> facets;
+    std::vector<cv::Point2f> centers;
+    subdiv.getVoronoiFacetList(std::vector<int>(), facets, centers);
+
+    std::vector<cv::Point2f> bounds = {
+        cv::Point2f(0, 0),
+        cv::Point2f(static_cast<float>(size.width), 0),
+        cv::Point2f(static_cast<float>(size.width), static_cast<float>(size.height)),
+        cv::Point2f(0, static_cast<float>(size.height))
+    };
+
+    std::vector<std::vector<cv::Point2f>> cells;
+    for (const auto& facet : facets) {
+        std::vector<cv::Point2f> clipped;
+        if (cv::intersectConvexConvex(facet, bounds, clipped) > 0.0f && clipped.size() >= 3) {
+            cells.push_back(clipped);
+        }
+    }
+    return cells;
+}
+
+cv::Mat generateVoronoi(const TemplateGeneratorConfig& config) {
+    int side = static_cast<int>(std::lround(std::sqrt(static_cast<double>(config.patch_count)) * config.patch_size));
+    cv::Size size(side, side);
+    cv::RNG rng(config.seed);
+
+    std::vector<cv::Point2f> sites;
+    for (int i = 0; i < config.patch_count; ++i) {
+        sites.push_back(cv::Point2f(rng.uniform(0.0f, static_cast<float>(side - 1)),
+            rng.uniform(0.0f, static_cast<float>(side - 1))));
+    }
+
+    // Lloyd: her noktayı hücresinin ağırlık merkezine taşı
+    std::vector<std::vector<cv::Point2f>> cells = voronoiCells(sites, size);
+    for (int iteration = 0; iteration < config.relax_iterations; ++iteration) {
+        sites.clear();
+        for (const auto& cell : cells) {
+            cv::Moments m = cv::moments(cell);
+            if (m.m00 <= 0) continue;
+            sites.push_back(cv::Point2f(
+                std::min(std::max(static_cast<float>(m.m10 / m.m00), 0.0f), static_cast<float>(side - 1)),
+                std::min(std::max(static_cast<float>(m.m01 / m.m00), 0.0f), static_cast<float>(side - 1))));
+        }
+        cells = voronoiCells(sites, size);
+    }
+
+    cv::Mat image(size, CV_8UC3, BACKGROUND_COLOR);
+    std::vector<std::vector<cv::Point>> outlines;
+    for (const auto& cell : cells) {
+        std::vector<cv::Point> outline;
+        for (const auto& pt : cell) {
+            outline.push_back(cv::Point(static_cast<int>(std::lround(pt.x)), static_cast<int>(std::lround(pt.y))));
+        }
+        outlines.push_back(outline);
+    }
+    cv::polylines(image, outlines, true, LINE_COLOR, config.line_thickness, cv::LINE_8);
+    cv::rectangle(image, cv::Rect(0, 0, side, side), LINE_COLOR, config.line_thickness);
+    return image;
+}
+
+cv::Mat generateGrid(const TemplateGeneratorConfig& config) {
+    int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(config.patch_count))));
+    int rows = (config.patch_count + cols - 1) / cols;
+    int step = config.patch_size;
+
+    cv::Mat image(rows * step, cols * step, CV_8UC3, BACKGROUND_COLOR);
+    for (int c = 0; c <= cols; ++c) {
+        int x = std::min(c * step, image.cols - 1);
+        cv::line(image, cv::Point(x, 0), cv::Point(x, image.rows - 1), LINE_COLOR, config.line_thickness);
+    }
+    for (int r = 0; r <= rows; ++r) {
+        int y = std::min(r * step, image.rows - 1);
+        cv::line(image, cv::Point(0, y), cv::Point(image.cols - 1, y), LINE_COLOR, config.line_thickness);
+    }
+    return image;
+}
+
+}
+
+cv::Mat generateTemplate(const TemplateGeneratorConfig& config) {
+    if (config.patch_count < 10) {
+        // Parça alanı görüntünün %20'sinden büyük olursa TemplateProcessor onu atar
+        throw std::runtime_error("Generated templates need at least 10 patches!");
+    }
+    if (config.patch_size < 8 || config.line_thickness < 1) {
+        throw std::runtime_error("Invalid patch size / line thickness!");
+    }
+    return config.layout == TemplateLayout::Grid ? generateGrid(config) : generateVoronoi(config);
+}
+
+TemplateLayout parseTemplateLayout(const std::string& name) {
+    if (name == "voronoi") return TemplateLayout::Voronoi;
+    if (name == "grid") return TemplateLayout::Grid;
+    throw std::runtime_error("Unknown template layout: " + name);
+}
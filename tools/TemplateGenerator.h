@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+// Ölçekleme testleri için sentetik mozaik template'i: beyaz zemin üzerinde siyah
+// çizgilerle ayrılmış parçalar. TemplateProcessor'ın beklediği biçimdedir
+// (çizgiler < 200 gri, parça alanı > 200 piksel ve < görüntünün %20'si).
+
+enum class TemplateLayout {
+    Voronoi,    // Lloyd ile düzenlenmiş Voronoi hücreleri (düzensiz çokgenler)
+    Grid        // Kare ızgara
+};
+
+struct TemplateGeneratorConfig {
+    TemplateLayout layout = TemplateLayout::Voronoi;
+    int patch_count = 100;
+    int patch_size = 28;            // Ortalama parça kenarı (piksel); çizgilerle birlikte alan eşiği için >= 20
+    int line_thickness = 2;
+    int relax_iterations = 2;       // Voronoi: Lloyd adımı, çok küçük hücreleri engeller
+    uint64_t seed = 12345;
+};
+
+cv::Mat generateTemplate(const TemplateGeneratorConfig& config);
+
+TemplateLayout parseTemplateLayout(const std::string& name);